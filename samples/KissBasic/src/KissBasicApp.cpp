@@ -190,8 +190,9 @@ void KissBasicApp::sineWave( uint64_t inSampleOffset, uint32_t ioSampleCount, au
 		mFft = Kiss::create( ioSampleCount );
 	}
 
-	// Analyze data
-	mFft->setData( ioBuffer->mData );
+	// Analyze data. The buffer is interleaved; both channels
+	// carry the same wave, so analyze their average
+	mFft->setData( ioBuffer->mData, ioBuffer->mNumberChannels, Kiss::Channel::DOWNMIX );
 
 }
 
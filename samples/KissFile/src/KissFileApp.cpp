@@ -172,18 +172,21 @@ void KissFileApp::update()
 		mBuffer = mTrack->getPcmBuffer();
 		if ( mBuffer && mBuffer->getInterleavedData() ) {
 
-			// Get sample count
-			uint32_t sampleCount = mBuffer->getInterleavedData()->mSampleCount;
+			// Get frame count. The interleaved buffer's own count
+			// includes every channel
+			uint32_t sampleCount = mBuffer->getSampleCount();
 			if ( sampleCount > 0 ) {
 
 				// Initialize analyzer
 				if ( !mFft ) {
 					mFft = Kiss::create( sampleCount );
+				} else if ( mFft->getDataSize() != (int32_t)sampleCount ) {
+					mFft->setDataSize( sampleCount );
 				}
 
-				// Analyze data
+				// Analyze the average of the channels
 				if ( mBuffer->getInterleavedData()->mData != 0 ) {
-					mFft->setData( mBuffer->getInterleavedData()->mData );
+					mFft->setData( mBuffer->getInterleavedData()->mData, mBuffer->getChannelCount(), Kiss::Channel::DOWNMIX );
 				}
 
 			}
@@ -252,8 +252,9 @@ void KissTempoApp::update()
 		mBuffer = mTrack->getPcmBuffer();
 		if ( mBuffer && mBuffer->getInterleavedData() ) {
 
-			// Get sample count
-			uint32_t sampleCount = mBuffer->getInterleavedData()->mSampleCount;
+			// Get frame count. The interleaved buffer's own count
+			// includes every channel
+			uint32_t sampleCount = mBuffer->getSampleCount();
 			if ( sampleCount > 0 ) {
 
 				// Kiss is not initialized
@@ -265,15 +266,22 @@ void KissTempoApp::update()
 					// Set filter on FFT to calculate tempo based on beats
 					mFft->setFilter( 0.2f, Kiss::Filter::LOW_PASS );
 
+				} else if ( mFft->getDataSize() != (int32_t)sampleCount ) {
+
+					// Follow the buffer size; the filter is kept
+					mFft->setDataSize( sampleCount );
+
 				}
 
 				// Analyze data
 				if ( mBuffer->getInterleavedData()->mData != 0 ) {
 
-					// Set FFT data
+					// Set FFT data, the average of the channels. The
+					// input size counts interleaved samples, as it
+					// bounds indices into mInputData
 					mInputData = mBuffer->getInterleavedData()->mData;
-					mInputSize = mBuffer->getInterleavedData()->mSampleCount;
-					mFft->setData( mInputData );
+					mInputSize = sampleCount * mBuffer->getChannelCount();
+					mFft->setData( mInputData, mBuffer->getChannelCount(), Kiss::Channel::DOWNMIX );
 
 					// Get data
 					mTimeData = mFft->getData();
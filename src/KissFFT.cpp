@@ -41,33 +41,107 @@
 using namespace ci;
 using namespace std;
 
-// Creates pointer to Kiss instance
-KissRef Kiss::create( int32_t dataSize )
+// Arena members start on a cache line
+static const size_t kArenaAlignment = 64;
+
+static inline size_t arenaSize( size_t bytes )
+{
+	return ( bytes + kArenaAlignment - 1 ) & ~( kArenaAlignment - 1 );
+}
+
+// Default memory resource. Over-allocates from kiss_fft_malloc()
+// and keeps the pointer it returned just below the aligned block
+class KissDefaultResource : public KissMemoryResource
+{
+
+public:
+
+	void* allocate( size_t bytes, size_t alignment )
+	{
+		char *raw = (char*)kiss_fft_malloc( bytes + alignment - 1 + sizeof( void* ) );
+		if ( raw == 0 ) {
+			throw bad_alloc();
+		}
+		char *p = (char*)( ( (uintptr_t)raw + sizeof( void* ) + alignment - 1 ) & ~(uintptr_t)( alignment - 1 ) );
+		( (void**)p )[ -1 ] = raw;
+		return p;
+	}
+
+	void deallocate( void *p, size_t /*bytes*/, size_t /*alignment*/ )
+	{
+		kiss_fft_free( ( (void**)p )[ -1 ] );
+	}
+
+};
+
+KissMemoryResource* KissMemoryResource::getDefault()
+{
+	static KissDefaultResource sDefaultResource;
+	return &sDefaultResource;
+}
+
+// Creates pointer to KissT instance
+template<typename Scalar>
+shared_ptr<KissT<Scalar> > KissT<Scalar>::create( int32_t dataSize, int32_t capacity, KissMemoryResource *memory )
 {
-	return KissRef( new Kiss( dataSize ) );
+	return shared_ptr<KissT>( new KissT( dataSize, capacity, memory ) );
 }
 
 // Constructor
-Kiss::Kiss( int32_t dataSize )
+template<typename Scalar>
+KissT<Scalar>::KissT( int32_t dataSize, int32_t capacity, KissMemoryResource *memory )
 {
 	// Set running flag
 	mRunning = true;
 
+	// Set frequencies
+	mFrequencyHigh	= 1.0f;
+	mFrequencyLow	= 0.0f;
+
 	// Set data size
+	mArena = 0;
+	mArenaSize = 0;
+	mMemory = memory != 0 ? memory : KissMemoryResource::getDefault();
 	mDataSize = dataSize;
-	setDataSize( dataSize );
+	if ( capacity > dataSize ) {
+		reserve( capacity );
+	} else {
+		setDataSize( dataSize );
+	}
 }
 
 // Destructor
-Kiss::~Kiss()
+template<typename Scalar>
+KissT<Scalar>::~KissT()
 {
 	// Clean up
 	stop();
     dispose();
 }
 
+// Move constructor
+template<typename Scalar>
+KissT<Scalar>::KissT( KissT &&rhs ) KISS_NOEXCEPT
+{
+	mArena = 0;
+	mArenaSize = 0;
+	moveFrom( rhs );
+}
+
+// Move assignment
+template<typename Scalar>
+KissT<Scalar>& KissT<Scalar>::operator=( KissT &&rhs ) KISS_NOEXCEPT
+{
+	if ( this != &rhs ) {
+		dispose();
+		moveFrom( rhs );
+	}
+	return *this;
+}
+
 // Polarize cartesian values
-void Kiss::cartesianToPolar()
+template<typename Scalar>
+void KissT<Scalar>::cartesianToPolar()
 {
 
 	// Check if polar data is current
@@ -79,8 +153,8 @@ void Kiss::cartesianToPolar()
 		// Find absolute maximums of and angles between values
 		// and use them to set the amplitude and phase data, respectively
         for ( int32_t i = 0; i < mBinSize; ++i ) {
-            mAmplitude[ i ] = math<float>::sqrt( math<float>::pow( mReal[ i ], 2 ) + math<float>::pow( mImag[ i ], 2 ) );
-            mPhase[ i ] = math<float>::atan2( mImag[ i ], mReal[ i ] );
+            mAmplitude[ i ] = math<Real>::sqrt( math<Real>::pow( mReal[ i ], 2 ) + math<Real>::pow( mImag[ i ], 2 ) );
+            mPhase[ i ] = math<Real>::atan2( mImag[ i ], mReal[ i ] );
 		}
 
 		// Set flags
@@ -93,7 +167,7 @@ void Kiss::cartesianToPolar()
     if ( !mPolarNormalized ) {
 
 		// Normalize values
-        float mNormalizer = 2.0f / mWindowSum;
+        Real mNormalizer = 2 / mWindowSum;
         for ( int32_t i = 0; i < mBinSize; ++i ) {
             mAmplitude[ i ] *= mNormalizer;
 		}
@@ -104,52 +178,108 @@ void Kiss::cartesianToPolar()
 }
 
 // Free resources
-void Kiss::dispose()
+template<typename Scalar>
+void KissT<Scalar>::dispose()
 {
-	// Free KISS resources
-	if ( mFftCfg ) {
-		kiss_fftr_free( mFftCfg );
-	}
-	if ( mIfftCfg ) {
-		kiss_fftr_free( mIfftCfg );
+	// The arrays and the KISS config live in the arena
+	if ( mArena != 0 ) {
+		mMemory->deallocate( mArena, mArenaSize, kArenaAlignment );
 	}
+	mArena = 0;
+	mArenaSize = 0;
+}
 
-    // Delete arrays
-	if ( mAmplitude != 0 ) {
-		delete [] mAmplitude;
-	}
-	if ( mCxIn != 0 ) {
-		delete [] mCxIn;
-	}
-	if ( mCxOut != 0 ) {
-		delete [] mCxOut;
-	}
-	if ( mData != 0 ) {
-		delete [] mData;
-	}
-	if ( mImag != 0 ) {
-		delete [] mImag;
-	}
-	if ( mInverseWindow != 0 ) {
-		delete [] mInverseWindow;
-	}
-	if ( mPhase != 0 ) {
-		delete [] mPhase;
-	}
-	if ( mReal != 0 ) {
-		delete [] mReal;
-	}
-	if ( mWindow != 0 ) {
-		delete [] mWindow;
-	}
-	if ( mWindowedData != 0 ) {
-		delete [] mWindowedData;
-	}
+// Take over another instance
+template<typename Scalar>
+void KissT<Scalar>::moveFrom( KissT &rhs )
+{
+	// Every pointer is into the arena, or borrowed, so
+	// they stay valid when the arena changes hands
+	mArena					= rhs.mArena;
+	mArenaSize				= rhs.mArenaSize;
+	mMemory					= rhs.mMemory;
+	mAmplitude				= rhs.mAmplitude;
+	mBorrowedData			= rhs.mBorrowedData;
+	mData					= rhs.mData;
+	mImag					= rhs.mImag;
+	mInverseWindow			= rhs.mInverseWindow;
+	mPhase					= rhs.mPhase;
+	mReal					= rhs.mReal;
+	mWindow					= rhs.mWindow;
+	mWindowedData			= rhs.mWindowedData;
+	mBinSize				= rhs.mBinSize;
+	mDataSize				= rhs.mDataSize;
+	mWindowSum				= rhs.mWindowSum;
+	mCartesianNormalized	= rhs.mCartesianNormalized;
+	mCartesianUpdated		= rhs.mCartesianUpdated;
+	mDataNormalized			= rhs.mDataNormalized;
+	mDataUpdated			= rhs.mDataUpdated;
+	mPolarNormalized		= rhs.mPolarNormalized;
+	mPolarUpdated			= rhs.mPolarUpdated;
+	mWindowedDataUpdated	= rhs.mWindowedDataUpdated;
+	mCxIn					= rhs.mCxIn;
+	mCxOut					= rhs.mCxOut;
+	mFftCfg					= rhs.mFftCfg;
+	mFrequencyHigh			= rhs.mFrequencyHigh;
+	mFrequencyLow			= rhs.mFrequencyLow;
+	mRunning				= rhs.mRunning;
+
+	// Leave rhs empty. setDataSize() allocates it a new arena
+	rhs.mArena			= 0;
+	rhs.mArenaSize		= 0;
+	rhs.mAmplitude		= 0;
+	rhs.mBorrowedData	= 0;
+	rhs.mData			= 0;
+	rhs.mImag			= 0;
+	rhs.mInverseWindow	= 0;
+	rhs.mPhase			= 0;
+	rhs.mReal			= 0;
+	rhs.mWindow			= 0;
+	rhs.mWindowedData	= 0;
+	rhs.mCxIn			= 0;
+	rhs.mCxOut			= 0;
+	rhs.mFftCfg			= 0;
+	rhs.mBinSize		= 0;
+	rhs.mDataSize		= 0;
+}
 
+// Lay out arrays and KISS config
+template<typename Scalar>
+size_t KissT<Scalar>::layout( int32_t dataSize, char *arena )
+{
+	// Each member starts on a cache line, in the
+	// order transform() touches them
+	int32_t binSize		= ( dataSize / 2 ) + 1;
+	size_t binBytes		= arenaSize( sizeof( Real ) * binSize );
+	size_t realBytes	= arenaSize( sizeof( Real ) * dataSize );
+	size_t scalarBytes	= arenaSize( sizeof( Scalar ) * dataSize );
+	size_t cpxBytes		= arenaSize( sizeof( Cpx ) * binSize );
+	size_t cfgBytes		= 0;
+	Core::alloc( dataSize, 0, &cfgBytes );
+	if ( arena != 0 ) {
+		char *next = arena;
+		mData			= (Scalar*)next;	next += scalarBytes;
+		mWindow			= (Real*)next;		next += realBytes;
+		mWindowedData	= (Scalar*)next;	next += scalarBytes;
+		mCxOut			= (Cpx*)next;		next += cpxBytes;
+		mReal			= (Real*)next;		next += binBytes;
+		mImag			= (Real*)next;		next += binBytes;
+		mAmplitude		= (Real*)next;		next += binBytes;
+		mPhase			= (Real*)next;		next += binBytes;
+		mInverseWindow	= (Real*)next;		next += realBytes;
+		mCxIn			= (Cpx*)next;		next += cpxBytes;
+
+		// The KISS config goes last. The plan serves both directions
+		// and belongs to this instance, so it transforms in the
+		// plan's own buffers and needs no scratch
+		mFftCfg = Core::alloc( dataSize, next, &cfgBytes );
+	}
+	return 4 * binBytes + 2 * realBytes + 2 * scalarBytes + 2 * cpxBytes + cfgBytes;
 }
 
 // Returns array of amplitudes in frequency domain
-float* Kiss::getAmplitude()
+template<typename Scalar>
+typename KissT<Scalar>::Real* KissT<Scalar>::getAmplitude()
 {
 	// Prepare and return amplitude data
     cartesianToPolar();
@@ -157,41 +287,41 @@ float* Kiss::getAmplitude()
 }
 
 // Get input data
-float* Kiss::getData()
+template<typename Scalar>
+Scalar* KissT<Scalar>::getData()
 {
+	// Copy borrowed data now that it is asked for
+	if ( mBorrowedData != 0 ) {
+		memcpy( mData, mBorrowedData, sizeof( Scalar ) * mDataSize );
+		mBorrowedData = 0;
+	}
+
 	// Data has not been updated
     if ( !mDataUpdated ) {
 
 		// Perform FFT
         transform();
 
-		// Perform inverse FFT
+		// Perform inverse FFT, into the windowed array. The spectrum
+		// goes in at the scale the forward transform put out, which
+		// keeps the full range of integer cores
+        Real mDenormalizer = mWindowSum / 2;
         for ( int32_t i = 0; i < mBinSize; ++i ) {
-            mCxIn[ i ].r = mReal[ i ];
-            mCxIn[ i ].i = mImag[ i ];
+            mCxIn[ i ].r = Core::fromSpectrum( mReal[ i ] * mDenormalizer, mDataSize );
+            mCxIn[ i ].i = Core::fromSpectrum( mImag[ i ] * mDenormalizer, mDataSize );
 		}
-        kiss_fftri( mIfftCfg, mCxIn, mData );
+        Core::inverse( mFftCfg, mCxIn, mWindowedData );
+        mWindowedDataUpdated = false;
 
-		// Populate data array
+		// Populate data array, removing the window and normalizing
+		// in one pass so that integer samples are rounded only once
+        Real mNormalizer = (Real)1 / mDataSize;
 		for ( int32_t i = 0; i < mDataSize; ++i ) {
-            mData[ i ] *= mInverseWindow[ i ];
+            mData[ i ] = Core::fromReal( Core::toSignal( mWindowedData[ i ], mDataSize ) * mInverseWindow[ i ] * mNormalizer );
 		}
 
 		// Update flags
         mDataUpdated = true;
-        mDataUpdated = true;
-        mDataNormalized = false;
-
-    }
-
-	// Data has not been normalized
-    if ( !mDataNormalized ) {
-
-        // Normalize data
-        float mNormalizer = (float)mWindowSum / (float)( 2 * mDataSize );
-		for ( int32_t i = 0; i < mDataSize; ++i ) {
-            mData[ i ] *= mNormalizer;
-		}
         mDataNormalized = true;
 
     }
@@ -202,7 +332,8 @@ float* Kiss::getData()
 }
 
 // Returns array of phase values in frequency domain
-float* Kiss::getPhase()
+template<typename Scalar>
+typename KissT<Scalar>::Real* KissT<Scalar>::getPhase()
 {
 	// Prepare and return phase data
     cartesianToPolar();
@@ -210,7 +341,8 @@ float* Kiss::getPhase()
 }
 
 // Returns array of real part of complex values
-float* Kiss::getReal()
+template<typename Scalar>
+typename KissT<Scalar>::Real* KissT<Scalar>::getReal()
 {
 	// Perform FFT and return real data
     transform();
@@ -218,20 +350,23 @@ float* Kiss::getReal()
 }
 
 // Returns array of imaginary part of complex values
-float* Kiss::getImaginary()
+template<typename Scalar>
+typename KissT<Scalar>::Real* KissT<Scalar>::getImaginary()
 {
 	// Perform FFT and return imaginary data
     transform();
     return mImag;
 }
 
-void Kiss::removeFilter()
+template<typename Scalar>
+void KissT<Scalar>::removeFilter()
 {
 	setFilter( 0.0f, Filter::NONE );
 }
 
 // Send signal to KISS
-void Kiss::setData( float *data )
+template<typename Scalar>
+void KissT<Scalar>::setData( Scalar *data )
 {
     // Set all flags to false
     mCartesianUpdated = false;
@@ -242,21 +377,108 @@ void Kiss::setData( float *data )
     mDataNormalized = false;
 
 	// Copy incoming data
-    memcpy( mData, data, sizeof( float ) * mDataSize );
+    memcpy( mData, data, sizeof( Scalar ) * mDataSize );
+    mBorrowedData = 0;
 
 	// Set data flag
     mDataUpdated = true;
     mDataNormalized = true;
+    mWindowedDataUpdated = false;
 }
 
-// Set data size
-void Kiss::setDataSize( int32_t dataSize )
+// Lend signal to KISS
+template<typename Scalar>
+void KissT<Scalar>::borrowData( const Scalar *data )
 {
-	// Dispose if size has changed
-	if ( dataSize != mDataSize ) {
-		dispose();
+    // Set flags as setData() does
+    mCartesianUpdated = false;
+    mPolarUpdated = false;
+    mCartesianNormalized = false;
+    mPolarNormalized = false;
+    mDataUpdated = true;
+    mDataNormalized = true;
+    mWindowedDataUpdated = false;
+
+	// Keep the caller's buffer; transform() windows from it
+    mBorrowedData = data;
+}
+
+// Values of samples; PCM is sign-extended
+static inline float sampleValue( float sample )
+{
+	return sample;
+}
+static inline int32_t sampleValue( int16_t sample )
+{
+	return sample;
+}
+static inline int32_t sampleValue( const KissInt24 &sample )
+{
+	return (int32_t)( (uint32_t)sample.bytes[ 0 ] << 8 | (uint32_t)sample.bytes[ 1 ] << 16 | (uint32_t)sample.bytes[ 2 ] << 24 ) >> 8;
+}
+
+// Send one channel of interleaved data to KISS
+template<typename Scalar>
+void KissT<Scalar>::setData( const float *data, int32_t channelCount, int32_t channel )
+{
+	setInterleaved( data, channelCount, channel, 1 );
+}
+
+// Send 16-bit PCM to KISS
+template<typename Scalar>
+void KissT<Scalar>::setData( const int16_t *data, int32_t channelCount, int32_t channel )
+{
+	setInterleaved( data, channelCount, channel, 32768 );
+}
+
+// Send packed 24-bit PCM to KISS
+template<typename Scalar>
+void KissT<Scalar>::setData( const KissInt24 *data, int32_t channelCount, int32_t channel )
+{
+	setInterleaved( data, channelCount, channel, 8388608 );
+}
+
+// De-interleave, convert, scale and window in one pass
+template<typename Scalar>
+template<typename Sample>
+void KissT<Scalar>::setInterleaved( const Sample *data, int32_t channelCount, int32_t channel, Real fullScale )
+{
+	// Set flags; the data array is left stale and
+	// recovered by getData() from the spectrum
+    mCartesianUpdated = false;
+    mPolarUpdated = false;
+    mCartesianNormalized = false;
+    mPolarNormalized = false;
+    mDataUpdated = false;
+    mDataNormalized = false;
+    mBorrowedData = 0;
+
+	// Write the FFT input directly. The loops have no branches
+	// or dependencies between frames, so compilers vectorize them
+	Real scale = 1 / fullScale;
+	if ( channel == Channel::DOWNMIX ) {
+		scale /= channelCount;
+		for ( int32_t i = 0; i < mDataSize; ++i ) {
+			const Sample *frame = data + i * channelCount;
+			Real sum = 0;
+			for ( int32_t j = 0; j < channelCount; ++j ) {
+				sum += sampleValue( frame[ j ] );
+			}
+			mWindowedData[ i ] = Core::fromReal( sum * scale * mWindow[ i ] );
+		}
+	} else {
+		data += channel;
+		for ( int32_t i = 0; i < mDataSize; ++i ) {
+			mWindowedData[ i ] = Core::fromReal( sampleValue( data[ i * channelCount ] ) * scale * mWindow[ i ] );
+		}
 	}
+    mWindowedDataUpdated = true;
+}
 
+// Set data size
+template<typename Scalar>
+void KissT<Scalar>::setDataSize( int32_t dataSize )
+{
 	// Set dimensions
     mDataSize	= dataSize;
     mBinSize	= ( mDataSize / 2 ) + 1;
@@ -268,42 +490,51 @@ void Kiss::setDataSize( int32_t dataSize )
 	mDataNormalized			= true;
     mPolarNormalized		= true;
 	mPolarUpdated			= true;
-
-    // Allocate arrays
-    mAmplitude		= new float[ mBinSize ];
-	mData			= new float[ mDataSize ];
-	mImag			= new float[ mBinSize ];
-	mInverseWindow	= new float[ mDataSize ];
-	mReal			= new float[ mBinSize ];
-    mPhase			= new float[ mBinSize ];
-	mWindow			= new float[ mDataSize ];
-	mWindowedData	= new float[ mDataSize ];
-
-	// Set frequencies
-	mFrequencyHigh	= 1.0f;
-	mFrequencyLow	= 0.0f;
+	mDataUpdated			= true;
+	mWindowedDataUpdated	= false;
+	mBorrowedData			= 0;
+
+	// Grow the arena if this size does not fit, then lay out the
+	// arrays and KISS config in it
+	size_t arenaBytes = layout( dataSize, 0 );
+	if ( arenaBytes > mArenaSize ) {
+		dispose();
+		mArena = (char*)mMemory->allocate( arenaBytes, kArenaAlignment );
+		mArenaSize = arenaBytes;
+	}
+	layout( dataSize, mArena );
 
     // Initialize array values
-    memset( mData, 0, sizeof( float ) * mDataSize );
-    memset( mReal, 0, sizeof( float ) * mBinSize );
-    memset( mImag, 0, sizeof( float ) * mBinSize );
-    memset( mAmplitude, 0, sizeof( float ) * mBinSize );
-    memset( mPhase, 0, sizeof( float ) * mBinSize );
+    memset( mData, 0, sizeof( Scalar ) * mDataSize );
+    memset( mReal, 0, sizeof( Real ) * mBinSize );
+    memset( mImag, 0, sizeof( Real ) * mBinSize );
+    memset( mAmplitude, 0, sizeof( Real ) * mBinSize );
+    memset( mPhase, 0, sizeof( Real ) * mBinSize );
 	for ( int32_t i = 0; i < mDataSize; ++i ) {
-        mWindow[ i ] = math<float>::sin( ( (float)M_PI * i) / ( mDataSize - 1 ) );
+        mWindow[ i ] = math<Real>::sin( ( (Real)M_PI * i) / ( mDataSize - 1 ) );
         mWindowSum += mWindow[ i ];
-        mInverseWindow[ i ] = 1.0f / mWindow[ i ];
+        mInverseWindow[ i ] = 1 / mWindow[ i ];
 	}
+}
 
-	// Set up KISS
-    mFftCfg		= kiss_fftr_alloc( mDataSize, 0, 0, 0 );
-    mIfftCfg	= kiss_fftr_alloc( mDataSize, 1, 0, 0 );
-    mCxIn		= new kiss_fft_cpx[ mBinSize ];
-    mCxOut		= new kiss_fft_cpx[ mBinSize ];
+// Grow arena
+template<typename Scalar>
+void KissT<Scalar>::reserve( int32_t capacity )
+{
+	// Reallocate and lay out the current size
+	// again if capacity does not fit
+	size_t arenaBytes = layout( capacity, 0 );
+	if ( arenaBytes > mArenaSize ) {
+		dispose();
+		mArena = (char*)mMemory->allocate( arenaBytes, kArenaAlignment );
+		mArenaSize = arenaBytes;
+		setDataSize( mDataSize );
+	}
 }
 
 // Set filter
-void Kiss::setFilter( float frequency, int32_t filter )
+template<typename Scalar>
+void KissT<Scalar>::setFilter( float frequency, int32_t filter )
 {
 	// Set low and high frequencies based on filter type
 	switch ( filter ) {
@@ -323,7 +554,8 @@ void Kiss::setFilter( float frequency, int32_t filter )
 }
 
 // Set band pass filter
-void Kiss::setFilter( float lowFrequency, float highFrequency )
+template<typename Scalar>
+void KissT<Scalar>::setFilter( float lowFrequency, float highFrequency )
 {
 	// Set frequencies
 	mFrequencyLow = lowFrequency;
@@ -331,14 +563,16 @@ void Kiss::setFilter( float lowFrequency, float highFrequency )
 }
 
 // Stop running
-void Kiss::stop()
+template<typename Scalar>
+void KissT<Scalar>::stop()
 {
 	// Turn off flag (prevents crash on exit)
 	mRunning = false;
 }
 
 // Performs FFT
-void Kiss::transform()
+template<typename Scalar>
+void KissT<Scalar>::transform()
 {
 	// Check flag
 	if ( !mRunning ) {
@@ -351,14 +585,18 @@ void Kiss::transform()
 		// Polar values need updating
         if ( !mPolarUpdated ) {
 
-			// Copy data to windowed array
-            memcpy( mWindowedData, mData, sizeof(float) * mDataSize );
-			for ( int32_t i = 0; i < mDataSize; ++i ) {
-                mWindowedData[ i ] = mData[ i ] * mWindow[ i ];
+			// Window data, or the borrowed buffer, into the FFT
+			// input, unless PCM input was windowed on the way in
+			if ( !mWindowedDataUpdated ) {
+				const Scalar *data = mBorrowedData != 0 ? mBorrowedData : mData;
+				for ( int32_t i = 0; i < mDataSize; ++i ) {
+					mWindowedData[ i ] = Core::fromReal( Core::toReal( data[ i ] ) * mWindow[ i ] );
+				}
+				mWindowedDataUpdated = true;
 			}
 
 			// Perform FFT
-            kiss_fftr( mFftCfg, mWindowedData, mCxOut );
+            Core::forward( mFftCfg, mWindowedData, mCxOut );
 
 			// Iterate through complex values
 			for ( int32_t i = 0; i < mBinSize; ++i ) {
@@ -372,8 +610,8 @@ void Kiss::transform()
 				bool mApplyComlex = i >= mFrequencyLow * mBinSize && i <= mFrequencyHigh * mBinSize;
 
 				// Extract complex values
-				mReal[ i ] = mApplyComlex ? mCxOut[ i ].r : 0.0f;
-				mImag[ i ] = mApplyComlex ? mCxOut[ i ].i : 0.0f;
+				mReal[ i ] = mApplyComlex ? Core::toSpectrum( mCxOut[ i ].r, mDataSize ) : 0;
+				mImag[ i ] = mApplyComlex ? Core::toSpectrum( mCxOut[ i ].i, mDataSize ) : 0;
 
 			}
 
@@ -384,8 +622,8 @@ void Kiss::transform()
 
 			// Apply phase and amplitude to values
 			for ( int32_t i = 0; i < mBinSize; ++i ) {
-                mReal[ i ] = math<float>::cos( mPhase[ i ] ) * mAmplitude[ i ];
-                mImag[ i ] = math<float>::sin( mPhase[ i ] ) * mAmplitude[ i ];
+                mReal[ i ] = math<Real>::cos( mPhase[ i ] ) * mAmplitude[ i ];
+                mImag[ i ] = math<Real>::sin( mPhase[ i ] ) * mAmplitude[ i ];
 			}
             mCartesianUpdated = true;
             mCartesianNormalized = mPolarNormalized;
@@ -398,7 +636,7 @@ void Kiss::transform()
     if ( !mCartesianNormalized ) {
 
 		// Normalize values
-        float mNormalizer = 2.0f / mWindowSum;
+        Real mNormalizer = 2 / mWindowSum;
 		for ( int32_t i = 0; i < mBinSize; ++i ) {
             mReal[ i ] *= mNormalizer;
             mImag[ i ] *= mNormalizer;
@@ -407,3 +645,327 @@ void Kiss::transform()
 
     }
 }
+
+// The three precisions
+template class KissT<float>;
+template class KissT<double>;
+template class KissT<int16_t>;
+
+// Creates pointer to KissBatch instance
+KissBatchRef KissBatch::create( int32_t channelCount, int32_t dataSize )
+{
+	return KissBatchRef( new KissBatch( channelCount, dataSize ) );
+}
+
+// Constructor
+KissBatch::KissBatch( int32_t channelCount, int32_t dataSize )
+{
+	// Set dimensions
+	mChannelCount	= channelCount;
+	mDataSize		= dataSize;
+	mBinSize		= ( mDataSize / 2 ) + 1;
+	mWindowSum		= 0.0f;
+
+	// Set flags
+	mCartesianUpdated	= true;
+	mPolarUpdated		= true;
+
+	// Allocate arrays
+	mAmplitude		= new float[ mChannelCount * mBinSize ];
+	mImag			= new float[ mChannelCount * mBinSize ];
+	mPhase			= new float[ mChannelCount * mBinSize ];
+	mReal			= new float[ mChannelCount * mBinSize ];
+	mWindow			= new float[ mDataSize ];
+	mWindowedData	= new float[ mChannelCount * mDataSize ];
+
+	// Initialize array values
+	memset( mAmplitude, 0, sizeof( float ) * mChannelCount * mBinSize );
+	memset( mImag, 0, sizeof( float ) * mChannelCount * mBinSize );
+	memset( mPhase, 0, sizeof( float ) * mChannelCount * mBinSize );
+	memset( mReal, 0, sizeof( float ) * mChannelCount * mBinSize );
+	memset( mWindowedData, 0, sizeof( float ) * mChannelCount * mDataSize );
+	for ( int32_t i = 0; i < mDataSize; ++i ) {
+		mWindow[ i ] = math<float>::sin( ( (float)M_PI * i) / ( mDataSize - 1 ) );
+		mWindowSum += mWindow[ i ];
+	}
+
+	// Set up KISS, one row of input and output per channel
+	mFftCfg		= kiss_fftr_batch_alloc( mDataSize, 0, 0, 0, 0 );
+	mCxOut		= new kiss_fft_cpx[ mChannelCount * mBinSize ];
+	mTimeData	= new float*[ mChannelCount ];
+	mFreqData	= new kiss_fft_cpx*[ mChannelCount ];
+	for ( int32_t i = 0; i < mChannelCount; ++i ) {
+		mTimeData[ i ] = mWindowedData + i * mDataSize;
+		mFreqData[ i ] = mCxOut + i * mBinSize;
+	}
+}
+
+// Destructor
+KissBatch::~KissBatch()
+{
+	// Free KISS resources
+	if ( mFftCfg ) {
+		kiss_fftr_batch_free( mFftCfg );
+	}
+
+	// Delete arrays
+	delete [] mAmplitude;
+	delete [] mCxOut;
+	delete [] mFreqData;
+	delete [] mImag;
+	delete [] mPhase;
+	delete [] mReal;
+	delete [] mTimeData;
+	delete [] mWindow;
+	delete [] mWindowedData;
+}
+
+// Polarize cartesian values of every channel
+void KissBatch::cartesianToPolar()
+{
+	// Check if polar data is current
+	if ( !mPolarUpdated ) {
+
+		// Perform FFT
+		transform();
+
+		// Values are already normalized by transform()
+		for ( int32_t i = 0; i < mChannelCount * mBinSize; ++i ) {
+			mAmplitude[ i ] = math<float>::sqrt( mReal[ i ] * mReal[ i ] + mImag[ i ] * mImag[ i ] );
+			mPhase[ i ] = math<float>::atan2( mImag[ i ], mReal[ i ] );
+		}
+		mPolarUpdated = true;
+
+	}
+}
+
+// Returns array of amplitudes for one channel
+float* KissBatch::getAmplitude( int32_t channel )
+{
+	cartesianToPolar();
+	return mAmplitude + channel * mBinSize;
+}
+
+// Returns array of imaginary parts for one channel
+float* KissBatch::getImaginary( int32_t channel )
+{
+	transform();
+	return mImag + channel * mBinSize;
+}
+
+// Returns array of phase values for one channel
+float* KissBatch::getPhase( int32_t channel )
+{
+	cartesianToPolar();
+	return mPhase + channel * mBinSize;
+}
+
+// Returns array of real parts for one channel
+float* KissBatch::getReal( int32_t channel )
+{
+	transform();
+	return mReal + channel * mBinSize;
+}
+
+// Window and store one channel's signal
+void KissBatch::setData( int32_t channel, float *data )
+{
+	// Set flags
+	mCartesianUpdated = false;
+	mPolarUpdated = false;
+
+	// Window incoming data
+	float *windowedData = mWindowedData + channel * mDataSize;
+	for ( int32_t i = 0; i < mDataSize; ++i ) {
+		windowedData[ i ] = data[ i ] * mWindow[ i ];
+	}
+}
+
+// Performs FFT on all channels in one batch
+void KissBatch::transform()
+{
+	// Check if complex data is current
+	if ( !mCartesianUpdated ) {
+
+		// Transform every channel
+		kiss_fftr_batch( mFftCfg, mTimeData, mFreqData, mChannelCount );
+
+		// Extract and normalize complex values
+		float mNormalizer = 2.0f / mWindowSum;
+		for ( int32_t i = 0; i < mChannelCount * mBinSize; ++i ) {
+			mReal[ i ] = mCxOut[ i ].r * mNormalizer;
+			mImag[ i ] = mCxOut[ i ].i * mNormalizer;
+		}
+		mCartesianUpdated = true;
+
+	}
+}
+
+// Creates pointer to KissStereo instance
+KissStereoRef KissStereo::create( int32_t dataSize )
+{
+	return KissStereoRef( new KissStereo( dataSize ) );
+}
+
+// Constructor
+KissStereo::KissStereo( int32_t dataSize )
+{
+	// Set dimensions
+	mDataSize		= dataSize;
+	mBinSize		= ( mDataSize / 2 ) + 1;
+	mWindowSum		= 0.0f;
+
+	// Set flags
+	mCartesianUpdated	= true;
+	mPolarUpdated		= true;
+
+	// Allocate arrays
+	mAmplitude		= new float[ 2 * mBinSize ];
+	mImag			= new float[ 2 * mBinSize ];
+	mPhase			= new float[ 2 * mBinSize ];
+	mReal			= new float[ 2 * mBinSize ];
+	mWindow			= new float[ mDataSize ];
+
+	// Initialize array values
+	memset( mAmplitude, 0, sizeof( float ) * 2 * mBinSize );
+	memset( mImag, 0, sizeof( float ) * 2 * mBinSize );
+	memset( mPhase, 0, sizeof( float ) * 2 * mBinSize );
+	memset( mReal, 0, sizeof( float ) * 2 * mBinSize );
+	for ( int32_t i = 0; i < mDataSize; ++i ) {
+		mWindow[ i ] = math<float>::sin( ( (float)M_PI * i) / ( mDataSize - 1 ) );
+		mWindowSum += mWindow[ i ];
+	}
+
+	// Set up KISS, a complex plan of the full length from the
+	// process-wide cache, transforming in this instance's scratch
+	mFftCfg		= kfc_acquire( mDataSize, 0 );
+	mCxIn		= new kiss_fft_cpx[ mDataSize ];
+	mCxOut		= new kiss_fft_cpx[ mDataSize ];
+	mScratch	= new kiss_fft_cpx[ kiss_fft_scratch_size( mFftCfg ) / sizeof( kiss_fft_cpx ) ];
+	memset( mCxIn, 0, sizeof( kiss_fft_cpx ) * mDataSize );
+}
+
+// Destructor
+KissStereo::~KissStereo()
+{
+	// Free KISS resources
+	if ( mFftCfg ) {
+		kfc_release( mFftCfg );
+	}
+
+	// Delete arrays
+	delete [] mAmplitude;
+	delete [] mCxIn;
+	delete [] mCxOut;
+	delete [] mImag;
+	delete [] mPhase;
+	delete [] mReal;
+	delete [] mScratch;
+	delete [] mWindow;
+}
+
+// Polarize cartesian values of both channels
+void KissStereo::cartesianToPolar()
+{
+	// Check if polar data is current
+	if ( !mPolarUpdated ) {
+
+		// Perform FFT
+		transform();
+
+		// Values are already normalized by transform()
+		for ( int32_t i = 0; i < 2 * mBinSize; ++i ) {
+			mAmplitude[ i ] = math<float>::sqrt( mReal[ i ] * mReal[ i ] + mImag[ i ] * mImag[ i ] );
+			mPhase[ i ] = math<float>::atan2( mImag[ i ], mReal[ i ] );
+		}
+		mPolarUpdated = true;
+
+	}
+}
+
+// Returns array of amplitudes for one channel
+float* KissStereo::getAmplitude( int32_t channel )
+{
+	cartesianToPolar();
+	return mAmplitude + channel * mBinSize;
+}
+
+// Returns array of imaginary parts for one channel
+float* KissStereo::getImaginary( int32_t channel )
+{
+	transform();
+	return mImag + channel * mBinSize;
+}
+
+// Returns array of phase values for one channel
+float* KissStereo::getPhase( int32_t channel )
+{
+	cartesianToPolar();
+	return mPhase + channel * mBinSize;
+}
+
+// Returns array of real parts for one channel
+float* KissStereo::getReal( int32_t channel )
+{
+	transform();
+	return mReal + channel * mBinSize;
+}
+
+// Window both channels into one complex signal
+void KissStereo::setData( const float *left, const float *right )
+{
+	// Set flags
+	mCartesianUpdated = false;
+	mPolarUpdated = false;
+
+	// Left is real, right imaginary
+	for ( int32_t i = 0; i < mDataSize; ++i ) {
+		mCxIn[ i ].r = left[ i ] * mWindow[ i ];
+		mCxIn[ i ].i = right[ i ] * mWindow[ i ];
+	}
+}
+
+// Window interleaved pairs, which are laid out as complex values already
+void KissStereo::setData( const float *data )
+{
+	// Set flags
+	mCartesianUpdated = false;
+	mPolarUpdated = false;
+
+	// Window incoming data
+	for ( int32_t i = 0; i < mDataSize; ++i ) {
+		mCxIn[ i ].r = data[ 2 * i ] * mWindow[ i ];
+		mCxIn[ i ].i = data[ 2 * i + 1 ] * mWindow[ i ];
+	}
+}
+
+// Performs FFT and separates the channels
+void KissStereo::transform()
+{
+	// Check if complex data is current
+	if ( !mCartesianUpdated ) {
+
+		// Transform both channels at once
+		kiss_fft_scratch( mFftCfg, mCxIn, mCxOut, mScratch );
+
+		// The spectra of real signals are conjugate symmetric, so with
+		// Z = FFT( left + i * right ) and Y the conjugate of Z[ N - k ],
+		// left's bin k is ( Z[ k ] + Y ) / 2 and right's ( Z[ k ] - Y ) / 2i.
+		// The halves are folded into the normalization
+		float mNormalizer = 1.0f / mWindowSum;
+		float *leftReal = mReal;
+		float *leftImag = mImag;
+		float *rightReal = mReal + mBinSize;
+		float *rightImag = mImag + mBinSize;
+		for ( int32_t k = 0; k < mBinSize; ++k ) {
+			const kiss_fft_cpx &z = mCxOut[ k ];
+			const kiss_fft_cpx &y = mCxOut[ k == 0 ? 0 : mDataSize - k ];
+			leftReal[ k ] = ( z.r + y.r ) * mNormalizer;
+			leftImag[ k ] = ( z.i - y.i ) * mNormalizer;
+			rightReal[ k ] = ( z.i + y.i ) * mNormalizer;
+			rightImag[ k ] = ( y.r - z.r ) * mNormalizer;
+		}
+		mCartesianUpdated = true;
+
+	}
+}
@@ -38,17 +38,167 @@
 
 // Includes
 #include "cinder/CinderMath.h"
+#include "kiss/kfc.h"
 #include "kiss/kiss_fftr.h"
+#include "kiss/kiss_fft_batch.h"
+#include "kiss/kiss_fft_sets.h"
 
-// Alias for pointer to Kiss instance
-typedef std::shared_ptr<class Kiss> KissRef;
+// noexcept where the compiler has it. Visual Studio reports an old
+// __cplusplus, and 2010 and 2012 lack the keyword
+#if __cplusplus >= 201103L || ( defined( _MSC_VER ) && _MSC_VER >= 1900 )
+#define KISS_NOEXCEPT noexcept
+#else
+#define KISS_NOEXCEPT
+#endif
 
-// KissFFT wrapper
-class Kiss
+// Binds a sample type to the symbol set of the core that transforms
+// it (see kiss/kiss_fft_sets.h) and to the scale of its values. Real
+// is the type of the spectra. int16_t samples are Q15, ie, 32767
+// is full scale, and their spectra are float in the same scale as
+// those of float samples
+template<typename Scalar>
+struct KissCore;
+
+template<>
+struct KissCore<float>
+{
+	typedef float			Real;
+	typedef kiss_fft_cpx	Cpx;
+	typedef kiss_fftr_cfg	Cfg;
+
+	static Cfg		alloc( int32_t dataSize, void *mem, size_t *lenmem ) { return kiss_fftr_alloc( dataSize, 0, mem, lenmem ); }
+	static void		forward( Cfg cfg, const float *in, Cpx *out ) { kiss_fftr( cfg, in, out ); }
+	static void		inverse( Cfg cfg, const Cpx *in, float *out ) { kiss_fftri( cfg, in, out ); }
+
+	// Samples to and from Real
+	static float	toReal( float v ) { return v; }
+	static float	fromReal( float v ) { return v; }
+
+	// Output of forward() to the spectrum and back, and output
+	// of inverse() to the unscaled inverse transform
+	static float	toSpectrum( float v, int32_t ) { return v; }
+	static float	fromSpectrum( float v, int32_t ) { return v; }
+	static float	toSignal( float v, int32_t ) { return v; }
+};
+
+template<>
+struct KissCore<double>
+{
+	typedef double				Real;
+	typedef kiss_fft_cpx_f64	Cpx;
+	typedef kiss_fftr_cfg_f64	Cfg;
+
+	static Cfg		alloc( int32_t dataSize, void *mem, size_t *lenmem ) { return kiss_fftr_alloc_f64( dataSize, 0, mem, lenmem ); }
+	static void		forward( Cfg cfg, const double *in, Cpx *out ) { kiss_fftr_f64( cfg, in, out ); }
+	static void		inverse( Cfg cfg, const Cpx *in, double *out ) { kiss_fftri_f64( cfg, in, out ); }
+
+	static double	toReal( double v ) { return v; }
+	static double	fromReal( double v ) { return v; }
+
+	static double	toSpectrum( double v, int32_t ) { return v; }
+	static double	fromSpectrum( double v, int32_t ) { return v; }
+	static double	toSignal( double v, int32_t ) { return v; }
+};
+
+// The fixed point core divides by dataSize in both directions to
+// stay in range, rounding at every stage. Spectra keep 10 to 12
+// bits; the inverse keeps about 15 - log2(dataSize), so getData()
+// of a KissInt16 is only useful for short transforms
+template<>
+struct KissCore<int16_t>
+{
+	typedef float				Real;
+	typedef kiss_fft_cpx_s16	Cpx;
+	typedef kiss_fftr_cfg_s16	Cfg;
+
+	static Cfg		alloc( int32_t dataSize, void *mem, size_t *lenmem ) { return kiss_fftr_alloc_s16( dataSize, 0, mem, lenmem ); }
+	static void		forward( Cfg cfg, const int16_t *in, Cpx *out ) { kiss_fftr_s16( cfg, in, out ); }
+	static void		inverse( Cfg cfg, const Cpx *in, int16_t *out ) { kiss_fftri_s16( cfg, in, out ); }
+
+	static float	toReal( int16_t v ) { return v * ( 1.0f / 32768.0f ); }
+	static int16_t	fromReal( float v ) { return saturate( v * 32768.0f ); }
+
+	static float	toSpectrum( int16_t v, int32_t dataSize ) { return v * ( dataSize / 32768.0f ); }
+	static int16_t	fromSpectrum( float v, int32_t dataSize ) { return saturate( v * ( 32768.0f / dataSize ) ); }
+	static float	toSignal( int16_t v, int32_t dataSize ) { return v * ( (float)dataSize * dataSize / 32768.0f ); }
+
+	// Rounds to the nearest int16_t, clamping to its range. NaN,
+	// from the zero ends of the window, becomes 0
+	static int16_t	saturate( float v )
+	{
+		if ( v != v ) {
+			return 0;
+		}
+		v += v < 0.0f ? -0.5f : 0.5f;
+		return v >= 32767.0f ? 32767 : v <= -32768.0f ? -32768 : (int16_t)v;
+	}
+};
+
+// Packed little-endian 24-bit PCM sample, as stored in WAV files
+struct KissInt24
+{
+	uint8_t			bytes[ 3 ];
+};
+
+// Source of the memory of Kiss instances, modelled on
+// std::pmr::memory_resource. The default one allocates through
+// kiss_fft_malloc(), so a hook set with kiss_fft_set_allocator()
+// serves the C core and the wrapper alike. A resource must outlive
+// every instance created with it
+class KissMemoryResource
+{
+
+public:
+
+	virtual ~KissMemoryResource() {}
+
+	// Returns bytes aligned to alignment, a power of two, or
+	// throws std::bad_alloc
+	virtual void*	allocate( size_t bytes, size_t alignment ) = 0;
+
+	// Releases memory returned by allocate() with the same arguments
+	virtual void	deallocate( void *p, size_t bytes, size_t alignment ) = 0;
+
+	// Resource used when none is given
+	static KissMemoryResource*	getDefault();
+
+};
+
+#if __cplusplus >= 201703L || ( defined( _MSVC_LANG ) && _MSVC_LANG >= 201703L )
+#include <memory_resource>
+
+// Adapts a std::pmr::memory_resource, eg, a monotonic or pool
+// resource, to Kiss
+class KissPmrResource : public KissMemoryResource
 {
 
 public:
 
+	explicit KissPmrResource( std::pmr::memory_resource *resource = std::pmr::get_default_resource() )
+		: mResource( resource ) {}
+
+	void*	allocate( size_t bytes, size_t alignment ) { return mResource->allocate( bytes, alignment ); }
+	void	deallocate( void *p, size_t bytes, size_t alignment ) { mResource->deallocate( p, bytes, alignment ); }
+
+private:
+
+	std::pmr::memory_resource	*mResource;
+
+};
+#endif
+
+// KissFFT wrapper, transforming samples of type Scalar (float,
+// double or int16_t). Each instance picks its precision; all three
+// may be used in one program
+template<typename Scalar>
+class KissT
+{
+
+public:
+
+	// Type of spectra: float, or double for double samples
+	typedef typename KissCore<Scalar>::Real	Real;
+
 	// Filter types
 	struct Filter
 	{
@@ -61,11 +211,34 @@ public:
 		};
 	};
 
-	// Creates pointer to Kiss instance
-	static KissRef	create( int32_t dataSize = 512 );
+	// Channel selection for interleaved input
+	struct Channel
+	{
+		enum
+		{
+			DOWNMIX = -1
+		};
+	};
+
+	// Creates pointer to KissT instance, with room for sizes up to
+	// capacity (see reserve()). Its arena is taken from memory, or
+	// from KissMemoryResource::getDefault() if it is null
+	static std::shared_ptr<KissT>	create( int32_t dataSize = 512, int32_t capacity = 0, KissMemoryResource *memory = 0 );
+
+	// Constructs an instance in place, as a member, in a container
+	// or on the stack, with the arguments of create()
+	explicit KissT( int32_t dataSize = 512, int32_t capacity = 0, KissMemoryResource *memory = 0 );
+
+	// Instances move but do not copy. Moving hands over the arena
+	// without touching it. A moved-from instance holds nothing and
+	// may only be destroyed, assigned to or given a size again with
+	// setDataSize(). Neither throws, so containers of instances move
+	// them rather than fail to copy them when they grow
+	KissT( KissT &&rhs ) KISS_NOEXCEPT;
+	KissT&			operator=( KissT &&rhs ) KISS_NOEXCEPT;
 
 	// De-structor
-	~Kiss();
+	~KissT();
 
 	// Stop processing
 	void			stop();
@@ -73,45 +246,83 @@ public:
 	// Convenience method for shutting off filter
 	void			removeFilter();
 
+	// Grows the arena to fit capacity points. setDataSize() only
+	// allocates when a size does not fit what the arena already
+	// holds, so after reserving the largest block size, block size
+	// changes cost no heap traffic. Sizes with large prime factors
+	// need bigger plans than the power of two above them, and may
+	// still grow it. Resets the instance if the arena grows
+	void			reserve( int32_t capacity );
+
 	// Setters
-	void			setData( float *data );
+	void			setData( Scalar *data );
 	void			setDataSize( int32_t dataSize );
 	void			setFilter( float lowFrequency, float highFrequency );
 	void			setFilter( float frequency, int32_t filter = Filter::LOW_PASS );
 
+	// Interleaved and PCM input. One channel of channelCount, or the
+	// average of all of them for Channel::DOWNMIX, is converted,
+	// scaled to full scale and windowed in one pass, straight into
+	// the FFT input. The signal is not kept, so getData() then
+	// returns it as recovered by the inverse transform
+	void			setData( const float *data, int32_t channelCount, int32_t channel );
+	void			setData( const int16_t *data, int32_t channelCount = 1, int32_t channel = 0 );
+	void			setData( const KissInt24 *data, int32_t channelCount = 1, int32_t channel = 0 );
+
+	// Zero-copy input. The buffer is windowed straight into the FFT
+	// input when the spectrum is first asked for, and copied only
+	// if getData() is called. It must stay valid and unchanged until
+	// the next setData(), borrowData() or setDataSize()
+	void			borrowData( const Scalar *data );
+
 	// Getters
-	float*			getAmplitude();
+	Real*			getAmplitude();
 	int32_t			getBinSize() { return mBinSize; }
-	float*			getData();
+	Scalar*			getData();
 	int32_t			getDataSize() { return mDataSize; }
-	float*			getImaginary();
-	float*			getPhase();
-	float*			getReal();
+	Real*			getImaginary();
+	Real*			getPhase();
+	Real*			getReal();
 
 private:
 
-	// Constructor
-	// NOTE: Make this public to build
-	// directory on the stack (advanced)
-	Kiss( int32_t dataSize = 512 );
+	typedef KissCore<Scalar>		Core;
+	typedef typename Core::Cpx		Cpx;
+
+	// Not copyable
+	KissT( const KissT &rhs );
+	KissT&			operator=( const KissT &rhs );
 
 	// Clean up
 	void			dispose();
 
+	// Takes over the arena and state of rhs, leaving it empty
+	void			moveFrom( KissT &rhs );
+
+	// Lays out the arrays and KISS config for dataSize points in
+	// the arena, or only measures them if arena is null
+	size_t			layout( int32_t dataSize, char *arena );
+
+	// One allocation holding every array and the KISS config
+	char			*mArena;
+	size_t			mArenaSize;
+	KissMemoryResource	*mMemory;
+
 	// Arrays
-	float			*mAmplitude;
-	float			*mData;
-	float			*mImag;
-	float			*mInverseWindow;
-	float			*mPhase;
-	float			*mReal;
-	float			*mWindow;
-	float			*mWindowedData;
+	Real			*mAmplitude;
+	const Scalar	*mBorrowedData;
+	Scalar			*mData;
+	Real			*mImag;
+	Real			*mInverseWindow;
+	Real			*mPhase;
+	Real			*mReal;
+	Real			*mWindow;
+	Scalar			*mWindowedData;
 
 	// Dimensions
 	int32_t			mBinSize;
 	int32_t			mDataSize;
-	float			mWindowSum;
+	Real			mWindowSum;
 
 	// Flags
 	bool			mCartesianNormalized;
@@ -120,6 +331,7 @@ private:
 	bool			mDataUpdated;
 	bool			mPolarNormalized;
 	bool			mPolarUpdated;
+	bool			mWindowedDataUpdated;
 
 	// Performs FFT
 	void			transform();
@@ -127,11 +339,15 @@ private:
 	// Sets amplitude and phase arrays
 	void			cartesianToPolar();
 
+	// Converts and windows one channel of interleaved
+	// samples whose full scale is fullScale
+	template<typename Sample>
+	void			setInterleaved( const Sample *data, int32_t channelCount, int32_t channel, Real fullScale );
+
 	// KissFFT
-	kiss_fft_cpx	*mCxIn;
-	kiss_fft_cpx	*mCxOut;
-	kiss_fftr_cfg	mFftCfg;
-	kiss_fftr_cfg	mIfftCfg;
+	Cpx				*mCxIn;
+	Cpx				*mCxOut;
+	typename Core::Cfg	mFftCfg;
 
 	// Filter frequencies
 	float			mFrequencyHigh;
@@ -141,3 +357,551 @@ private:
 	bool			mRunning;
 
 };
+
+// Kiss transforms float samples, KissDouble double samples
+// for offline analysis and KissInt16 Q15 samples
+typedef KissT<float>		Kiss;
+typedef KissT<double>		KissDouble;
+typedef KissT<int16_t>		KissInt16;
+
+// Aliases for shared instances, as made by create(). Instances
+// held by value need neither
+typedef std::shared_ptr<Kiss>		KissRef;
+typedef std::shared_ptr<KissDouble>	KissDoubleRef;
+typedef std::shared_ptr<KissInt16>	KissInt16Ref;
+
+// Alias for pointer to KissBatch instance
+typedef std::shared_ptr<class KissBatch> KissBatchRef;
+
+// Transforms several same-sized signals (eg, the channels of
+// a multichannel stream) together with kiss_fftr_batch
+class KissBatch
+{
+
+public:
+
+	// Creates pointer to KissBatch instance
+	static KissBatchRef	create( int32_t channelCount, int32_t dataSize = 512 );
+
+	// De-structor
+	~KissBatch();
+
+	// Setters
+	void			setData( int32_t channel, float *data );
+
+	// Getters
+	float*			getAmplitude( int32_t channel );
+	int32_t			getBinSize() { return mBinSize; }
+	int32_t			getChannelCount() { return mChannelCount; }
+	int32_t			getDataSize() { return mDataSize; }
+	float*			getImaginary( int32_t channel );
+	float*			getPhase( int32_t channel );
+	float*			getReal( int32_t channel );
+
+private:
+
+	// Constructor
+	KissBatch( int32_t channelCount, int32_t dataSize );
+
+	// Not copyable
+	KissBatch( const KissBatch &rhs );
+	KissBatch&		operator=( const KissBatch &rhs );
+
+	// Arrays, one row per channel
+	float			*mAmplitude;
+	float			*mImag;
+	float			*mPhase;
+	float			*mReal;
+	float			*mWindow;
+	float			*mWindowedData;
+
+	// Dimensions
+	int32_t			mBinSize;
+	int32_t			mChannelCount;
+	int32_t			mDataSize;
+	float			mWindowSum;
+
+	// Flags
+	bool			mCartesianUpdated;
+	bool			mPolarUpdated;
+
+	// Performs FFT on all channels
+	void			transform();
+
+	// Sets amplitude and phase arrays
+	void			cartesianToPolar();
+
+	// KissFFT
+	kiss_fft_cpx	*mCxOut;
+	float			**mTimeData;
+	kiss_fft_cpx	**mFreqData;
+	kiss_fftr_batch_cfg	mFftCfg;
+
+};
+
+// Alias for pointer to KissStereo instance
+typedef std::shared_ptr<class KissStereo> KissStereoRef;
+
+// Transforms a stereo signal with one complex FFT: left goes into
+// the real parts and right into the imaginary parts, and the two
+// spectra are separated by conjugate symmetry afterwards
+class KissStereo
+{
+
+public:
+
+	// Channels
+	struct Channel
+	{
+		enum
+		{
+			LEFT, 
+			RIGHT
+		};
+	};
+
+	// Creates pointer to KissStereo instance
+	static KissStereoRef	create( int32_t dataSize = 512 );
+
+	// De-structor
+	~KissStereo();
+
+	// Setters, from separate channels or from interleaved pairs
+	void			setData( const float *left, const float *right );
+	void			setData( const float *data );
+
+	// Getters
+	float*			getAmplitude( int32_t channel );
+	int32_t			getBinSize() { return mBinSize; }
+	int32_t			getDataSize() { return mDataSize; }
+	float*			getImaginary( int32_t channel );
+	float*			getPhase( int32_t channel );
+	float*			getReal( int32_t channel );
+
+private:
+
+	// Constructor
+	KissStereo( int32_t dataSize );
+
+	// Not copyable
+	KissStereo( const KissStereo &rhs );
+	KissStereo&		operator=( const KissStereo &rhs );
+
+	// Arrays, one row per channel
+	float			*mAmplitude;
+	float			*mImag;
+	float			*mPhase;
+	float			*mReal;
+	float			*mWindow;
+
+	// Dimensions
+	int32_t			mBinSize;
+	int32_t			mDataSize;
+	float			mWindowSum;
+
+	// Flags
+	bool			mCartesianUpdated;
+	bool			mPolarUpdated;
+
+	// Performs FFT and separates the channels
+	void			transform();
+
+	// Sets amplitude and phase arrays
+	void			cartesianToPolar();
+
+	// KissFFT
+	kiss_fft_cpx	*mCxIn;
+	kiss_fft_cpx	*mCxOut;
+	kiss_fft_cpx	*mScratch;
+	kiss_fft_cfg	mFftCfg;
+
+};
+
+// KissFixed<N> needs C++14 constexpr to build its tables at compile time
+#if __cplusplus >= 201402L || ( defined( _MSVC_LANG ) && _MSVC_LANG >= 201402L )
+
+#include <array>
+#include <utility>
+
+// Compile-time plan for KissFixed
+namespace KissFixedPlan
+{
+
+	// Complex value; always float, whatever kiss_fft_scalar is
+	struct Cpx
+	{
+		float r;
+		float i;
+	};
+
+	// Sine and cosine of |x| <= pi/4 from their Taylor series
+	constexpr double sinSeries( double x )
+	{
+		double x2 = x * x;
+		double term = x;
+		double sum = x;
+		for ( int k = 2; k < 20; k += 2 ) {
+			term *= -x2 / ( k * ( k + 1 ) );
+			sum += term;
+		}
+		return sum;
+	}
+	constexpr double cosSeries( double x )
+	{
+		double x2 = x * x;
+		double term = 1.0;
+		double sum = 1.0;
+		for ( int k = 1; k < 20; k += 2 ) {
+			term *= -x2 / ( k * ( k + 1 ) );
+			sum += term;
+		}
+		return sum;
+	}
+
+	// exp(2*pi*i*num/den), reduced to the first octant with
+	// exact integer arithmetic before the series are evaluated
+	constexpr Cpx turn( long num, long den )
+	{
+		const double halfPi = 1.57079632679489661923;
+		long r = ( ( num % den ) + den ) % den;
+		long quadrant = ( 4 * r ) / den;
+		long rem = 4 * r - quadrant * den;
+		double s = 0.0;
+		double c = 0.0;
+		if ( 2 * rem <= den ) {
+			double x = halfPi * rem / den;
+			s = sinSeries( x );
+			c = cosSeries( x );
+		} else {
+			double x = halfPi * ( den - rem ) / den;
+			s = cosSeries( x );
+			c = sinSeries( x );
+		}
+		Cpx v = { 0.0f, 0.0f };
+		switch ( quadrant ) {
+		case 0: v.r = (float)c; v.i = (float)s; break;
+		case 1: v.r = (float)-s; v.i = (float)c; break;
+		case 2: v.r = (float)-c; v.i = (float)-s; break;
+		default: v.r = (float)s; v.i = (float)-c; break;
+		}
+		return v;
+	}
+
+	// Radix of the outermost stage of an n-point transform. Powers
+	// of four use radix 4 throughout; otherwise one radix-2 stage
+	// comes first, so the innermost codelets are always radix 4
+	constexpr int radix( int n )
+	{
+		return n <= 2 ? n : ( ( n & 0x55555555 ) ? 4 : 2 );
+	}
+
+	// Twiddles, real FFT super twiddles and window for N real points
+	template<int N>
+	struct Tables
+	{
+		Cpx		twiddles[ N / 2 ];
+		Cpx		superTwiddles[ N / 4 ];
+		float	window[ N ];
+		float	windowSum;
+	};
+
+	template<int N>
+	constexpr Tables<N> makeTables()
+	{
+		Tables<N> t = {};
+		for ( int i = 0; i < N / 2; ++i ) {
+			t.twiddles[ i ] = turn( -i, N / 2 );
+		}
+		for ( int i = 0; i < N / 4; ++i ) {
+			t.superTwiddles[ i ] = turn( -( i + 1 ) - N / 4, N );
+		}
+		double sum = 0.0;
+		for ( int i = 0; i < N; ++i ) {
+			t.window[ i ] = turn( i, 2 * ( N - 1 ) ).i;
+			sum += t.window[ i ];
+		}
+		t.windowSum = (float)sum;
+		return t;
+	}
+
+	inline Cpx mul( const Cpx &a, const Cpx &b )
+	{
+		Cpx v = { a.r * b.r - a.i * b.i, a.r * b.i + a.i * b.r };
+		return v;
+	}
+
+	// Runs Body::at( k, out, tw ) for k = 0 .. M-1. Stages of up to
+	// eight butterflies are expanded into straight-line code with k a
+	// constant in each call; longer ones stay loops of fixed count,
+	// since unrolling every stage of a large N would mostly fill the
+	// instruction cache
+	template<typename Body, int M, bool Unroll = ( M <= 8 )>
+	struct Repeat
+	{
+		static void run( Cpx *out, const Cpx *tw )
+		{
+			for ( int k = 0; k < M; ++k ) {
+				Body::at( k, out, tw );
+			}
+		}
+	};
+
+	template<typename Body, int M>
+	struct Repeat<Body, M, true>
+	{
+		template<int... K>
+		static void expand( Cpx *out, const Cpx *tw, std::integer_sequence<int, K...> )
+		{
+			int expanded[] = { 0, ( Body::at( K, out, tw ), 0 )... };
+			(void)expanded;
+		}
+
+		static void run( Cpx *out, const Cpx *tw )
+		{
+			expand( out, tw, std::make_integer_sequence<int, M>() );
+		}
+	};
+
+	// One stage of butterflies over p sub-transforms of m points,
+	// as kf_bfly2 and kf_bfly4 but with every count and stride fixed
+	template<int P, int M, int FStride>
+	struct Butterfly;
+
+	template<int M, int FStride>
+	struct Butterfly<2, M, FStride>
+	{
+		static void at( int k, Cpx *out, const Cpx *tw )
+		{
+			Cpx t = mul( out[ k + M ], tw[ k * FStride ] );
+			out[ k + M ].r = out[ k ].r - t.r;
+			out[ k + M ].i = out[ k ].i - t.i;
+			out[ k ].r += t.r;
+			out[ k ].i += t.i;
+		}
+
+		static void run( Cpx *out, const Cpx *tw )
+		{
+			Repeat<Butterfly, M>::run( out, tw );
+		}
+	};
+
+	template<int M, int FStride>
+	struct Butterfly<4, M, FStride>
+	{
+		static void at( int k, Cpx *out, const Cpx *tw )
+		{
+			Cpx s0 = mul( out[ k + M ], tw[ k * FStride ] );
+			Cpx s1 = mul( out[ k + 2 * M ], tw[ k * 2 * FStride ] );
+			Cpx s2 = mul( out[ k + 3 * M ], tw[ k * 3 * FStride ] );
+			Cpx f0 = out[ k ];
+			Cpx s5 = { f0.r - s1.r, f0.i - s1.i };
+			Cpx s3 = { s0.r + s2.r, s0.i + s2.i };
+			Cpx s4 = { s0.r - s2.r, s0.i - s2.i };
+			f0.r += s1.r;
+			f0.i += s1.i;
+			out[ k ].r = f0.r + s3.r;
+			out[ k ].i = f0.i + s3.i;
+			out[ k + 2 * M ].r = f0.r - s3.r;
+			out[ k + 2 * M ].i = f0.i - s3.i;
+			out[ k + M ].r = s5.r + s4.i;
+			out[ k + M ].i = s5.i - s4.r;
+			out[ k + 3 * M ].r = s5.r - s4.i;
+			out[ k + 3 * M ].i = s5.i + s4.r;
+		}
+
+		static void run( Cpx *out, const Cpx *tw )
+		{
+			Repeat<Butterfly, M>::run( out, tw );
+		}
+	};
+
+	// Decimation in time over an n-point sub-transform whose input
+	// points are FStride apart, as kf_work
+	template<int Size, int FStride>
+	struct Work
+	{
+		static constexpr int p = radix( Size );
+		static constexpr int m = Size / p;
+
+		template<int... Q>
+		static void expand( Cpx *out, const Cpx *in, const Cpx *tw, std::integer_sequence<int, Q...> )
+		{
+			int expanded[] = { 0, ( Work<m, FStride * p>::run( out + Q * m, in + Q * FStride, tw ), 0 )... };
+			(void)expanded;
+		}
+
+		static void run( Cpx *out, const Cpx *in, const Cpx *tw )
+		{
+			expand( out, in, tw, std::make_integer_sequence<int, p>() );
+			Butterfly<p, m, FStride>::run( out, tw );
+		}
+	};
+
+	// Codelets: the innermost transforms, fully unrolled with no twiddles
+	template<int FStride>
+	struct Work<4, FStride>
+	{
+		static void run( Cpx *out, const Cpx *in, const Cpx * )
+		{
+			Cpx a = in[ 0 ];
+			Cpx b = in[ FStride ];
+			Cpx c = in[ 2 * FStride ];
+			Cpx d = in[ 3 * FStride ];
+			Cpx s0 = { a.r + c.r, a.i + c.i };
+			Cpx s1 = { a.r - c.r, a.i - c.i };
+			Cpx s2 = { b.r + d.r, b.i + d.i };
+			Cpx s3 = { b.r - d.r, b.i - d.i };
+			out[ 0 ].r = s0.r + s2.r;
+			out[ 0 ].i = s0.i + s2.i;
+			out[ 1 ].r = s1.r + s3.i;
+			out[ 1 ].i = s1.i - s3.r;
+			out[ 2 ].r = s0.r - s2.r;
+			out[ 2 ].i = s0.i - s2.i;
+			out[ 3 ].r = s1.r - s3.i;
+			out[ 3 ].i = s1.i + s3.r;
+		}
+	};
+
+	template<int FStride>
+	struct Work<2, FStride>
+	{
+		static void run( Cpx *out, const Cpx *in, const Cpx * )
+		{
+			Cpx a = in[ 0 ];
+			Cpx b = in[ FStride ];
+			out[ 0 ].r = a.r + b.r;
+			out[ 0 ].i = a.i + b.i;
+			out[ 1 ].r = a.r - b.r;
+			out[ 1 ].i = a.i - b.i;
+		}
+	};
+
+	template<int FStride>
+	struct Work<1, FStride>
+	{
+		static void run( Cpx *out, const Cpx *in, const Cpx * )
+		{
+			out[ 0 ] = in[ 0 ];
+		}
+	};
+
+}
+
+// Kiss specialized for N points at compile time. The factorization,
+// twiddles and window are constants, the loops of every stage have
+// fixed counts and strides, and all storage is held by value, so an
+// instance can live on the stack and never touches the heap. N must
+// be a power of two; there is no inverse transform or filter
+template<int N>
+class KissFixed
+{
+
+public:
+
+	static_assert( N >= 4 && ( N & ( N - 1 ) ) == 0, "KissFixed size must be a power of two, at least 4" );
+
+	KissFixed()
+		: mCartesianUpdated( true ), mPolarUpdated( true )
+	{
+		Cpx zero = { 0.0f, 0.0f };
+		mWindowedData.fill( zero );
+		mReal.fill( 0.0f );
+		mImag.fill( 0.0f );
+		mAmplitude.fill( 0.0f );
+		mPhase.fill( 0.0f );
+	}
+
+	// Setters
+	void			setData( const float *data )
+	{
+		// Set flags
+		mCartesianUpdated = false;
+		mPolarUpdated = false;
+
+		// Window incoming data, packed as N/2 complex points
+		// with the even samples in the real parts
+		for ( int32_t i = 0; i < N / 2; ++i ) {
+			mWindowedData[ i ].r = data[ 2 * i ] * sTables.window[ 2 * i ];
+			mWindowedData[ i ].i = data[ 2 * i + 1 ] * sTables.window[ 2 * i + 1 ];
+		}
+	}
+
+	// Getters
+	float*			getAmplitude() { cartesianToPolar(); return mAmplitude.data(); }
+	static constexpr int32_t	getBinSize() { return N / 2 + 1; }
+	static constexpr int32_t	getDataSize() { return N; }
+	float*			getImaginary() { transform(); return mImag.data(); }
+	float*			getPhase() { cartesianToPolar(); return mPhase.data(); }
+	float*			getReal() { transform(); return mReal.data(); }
+
+private:
+
+	typedef KissFixedPlan::Cpx Cpx;
+
+	// Arrays
+	std::array<float, N / 2 + 1>	mAmplitude;
+	std::array<float, N / 2 + 1>	mImag;
+	std::array<float, N / 2 + 1>	mPhase;
+	std::array<float, N / 2 + 1>	mReal;
+	std::array<Cpx, N / 2>			mWindowedData;
+	std::array<Cpx, N / 2>			mCxOut;
+
+	// Flags
+	bool			mCartesianUpdated;
+	bool			mPolarUpdated;
+
+	// Performs FFT of the packed windowed data, then the split
+	// of kiss_fftr, normalized as Kiss
+	void			transform()
+	{
+		if ( mCartesianUpdated ) {
+			return;
+		}
+
+		KissFixedPlan::Work<N / 2, 1>::run( mCxOut.data(), mWindowedData.data(), sTables.twiddles );
+
+		float normalizer = 2.0f / sTables.windowSum;
+		const int32_t half = N / 2;
+		Cpx dc = mCxOut[ 0 ];
+		mReal[ 0 ] = ( dc.r + dc.i ) * normalizer;
+		mReal[ half ] = ( dc.r - dc.i ) * normalizer;
+		mImag[ 0 ] = 0.0f;
+		mImag[ half ] = 0.0f;
+		for ( int32_t k = 1; k <= half / 2; ++k ) {
+			Cpx fpk = mCxOut[ k ];
+			Cpx fpnk = { mCxOut[ half - k ].r, -mCxOut[ half - k ].i };
+			Cpx f1k = { fpk.r + fpnk.r, fpk.i + fpnk.i };
+			Cpx f2k = { fpk.r - fpnk.r, fpk.i - fpnk.i };
+			Cpx tw = KissFixedPlan::mul( f2k, sTables.superTwiddles[ k - 1 ] );
+			mReal[ k ] = ( f1k.r + tw.r ) * 0.5f * normalizer;
+			mImag[ k ] = ( f1k.i + tw.i ) * 0.5f * normalizer;
+			mReal[ half - k ] = ( f1k.r - tw.r ) * 0.5f * normalizer;
+			mImag[ half - k ] = ( tw.i - f1k.i ) * 0.5f * normalizer;
+		}
+		mCartesianUpdated = true;
+	}
+
+	// Sets amplitude and phase arrays
+	void			cartesianToPolar()
+	{
+		if ( mPolarUpdated ) {
+			return;
+		}
+
+		transform();
+		for ( int32_t i = 0; i < N / 2 + 1; ++i ) {
+			mAmplitude[ i ] = ci::math<float>::sqrt( mReal[ i ] * mReal[ i ] + mImag[ i ] * mImag[ i ] );
+			mPhase[ i ] = ci::math<float>::atan2( mImag[ i ], mReal[ i ] );
+		}
+		mPolarUpdated = true;
+	}
+
+	// Tables, computed by the compiler
+	static constexpr KissFixedPlan::Tables<N>	sTables = KissFixedPlan::makeTables<N>();
+
+};
+
+template<int N>
+constexpr KissFixedPlan::Tables<N> KissFixed<N>::sTables;
+
+#endif
@@ -0,0 +1,372 @@
+/*
+ Structure-of-arrays complex FFT used by kiss_fft_batch.c.
+
+ This file is included once per lane count / instruction set, after defining:
+
+   KFB_L                lanes (independent transforms) per element
+   KFB_NAME(x)          function name for this instantiation
+   KFB_TARGET           function attribute enabling the instruction set
+   KFB_V                vector type holding KFB_W floats
+   KFB_W                floats per vector; KFB_L is a multiple of it
+   KFB_LOAD(p)          unaligned load of KFB_W floats starting at p
+   KFB_STORE(p,v)       unaligned store
+   KFB_SET1(s)          broadcast the float s
+   KFB_ADD(a,b), KFB_SUB(a,b), KFB_MUL(a,b)
+
+ Element j of lane l lives at re[j*KFB_L+l] and im[j*KFB_L+l]. The
+ butterflies are the scalar ones of kiss_fft.c with an inner loop over
+ the lanes in steps of KFB_W; every lane shares the same twiddle, so
+ each complex operation of the scalar code becomes a handful of plain
+ vector adds and multiplies with no shuffling.
+ */
+
+static KFB_TARGET void KFB_NAME(bfly2)(float * re,float * im,const size_t fstride,const kfb_plan * st,int m)
+{
+    const kiss_fft_cpx * tw = st->twiddles;
+    int u,l;
+    for (u=0;u<m;++u) {
+        const KFB_V wr = KFB_SET1(tw[u*fstride].r), wi = KFB_SET1(tw[u*fstride].i);
+        float * r0 = re + u*KFB_L, * i0 = im + u*KFB_L;
+        float * r1 = r0 + m*KFB_L, * i1 = i0 + m*KFB_L;
+        for (l=0;l<KFB_L;l+=KFB_W) {
+            const KFB_V ar = KFB_LOAD(r0+l), ai = KFB_LOAD(i0+l);
+            const KFB_V br = KFB_LOAD(r1+l), bi = KFB_LOAD(i1+l);
+            const KFB_V tr = KFB_SUB( KFB_MUL(br,wr) , KFB_MUL(bi,wi) );
+            const KFB_V ti = KFB_ADD( KFB_MUL(br,wi) , KFB_MUL(bi,wr) );
+            KFB_STORE( r1+l , KFB_SUB(ar,tr) ); KFB_STORE( i1+l , KFB_SUB(ai,ti) );
+            KFB_STORE( r0+l , KFB_ADD(ar,tr) ); KFB_STORE( i0+l , KFB_ADD(ai,ti) );
+        }
+    }
+}
+
+static KFB_TARGET void KFB_NAME(bfly3)(float * re,float * im,const size_t fstride,const kfb_plan * st,int m)
+{
+    const kiss_fft_cpx * tw = st->twiddles;
+    const KFB_V epi3 = KFB_SET1(tw[fstride*m].i);
+    const KFB_V half = KFB_SET1(.5f);
+    int u,l;
+    for (u=0;u<m;++u) {
+        const KFB_V w1r = KFB_SET1(tw[u*fstride].r), w1i = KFB_SET1(tw[u*fstride].i);
+        const KFB_V w2r = KFB_SET1(tw[2*u*fstride].r), w2i = KFB_SET1(tw[2*u*fstride].i);
+        float * r0 = re + u*KFB_L, * i0 = im + u*KFB_L;
+        float * r1 = r0 + m*KFB_L, * i1 = i0 + m*KFB_L;
+        float * r2 = r1 + m*KFB_L, * i2 = i1 + m*KFB_L;
+        for (l=0;l<KFB_L;l+=KFB_W) {
+            const KFB_V x0r = KFB_LOAD(r0+l), x0i = KFB_LOAD(i0+l);
+            const KFB_V x1r = KFB_LOAD(r1+l), x1i = KFB_LOAD(i1+l);
+            const KFB_V x2r = KFB_LOAD(r2+l), x2i = KFB_LOAD(i2+l);
+            const KFB_V s1r = KFB_SUB( KFB_MUL(x1r,w1r) , KFB_MUL(x1i,w1i) ), s1i = KFB_ADD( KFB_MUL(x1r,w1i) , KFB_MUL(x1i,w1r) );
+            const KFB_V s2r = KFB_SUB( KFB_MUL(x2r,w2r) , KFB_MUL(x2i,w2i) ), s2i = KFB_ADD( KFB_MUL(x2r,w2i) , KFB_MUL(x2i,w2r) );
+            const KFB_V s3r = KFB_ADD(s1r,s2r), s3i = KFB_ADD(s1i,s2i);
+            const KFB_V s0r = KFB_MUL( KFB_SUB(s1r,s2r) , epi3 ), s0i = KFB_MUL( KFB_SUB(s1i,s2i) , epi3 );
+            const KFB_V f1r = KFB_SUB( x0r , KFB_MUL(s3r,half) ), f1i = KFB_SUB( x0i , KFB_MUL(s3i,half) );
+            KFB_STORE( r0+l , KFB_ADD(x0r,s3r) ); KFB_STORE( i0+l , KFB_ADD(x0i,s3i) );
+            KFB_STORE( r2+l , KFB_ADD(f1r,s0i) ); KFB_STORE( i2+l , KFB_SUB(f1i,s0r) );
+            KFB_STORE( r1+l , KFB_SUB(f1r,s0i) ); KFB_STORE( i1+l , KFB_ADD(f1i,s0r) );
+        }
+    }
+}
+
+static KFB_TARGET void KFB_NAME(bfly4)(float * re,float * im,const size_t fstride,const kfb_plan * st,int m)
+{
+    const kiss_fft_cpx * tw = st->twiddles;
+    const KFB_V sg = KFB_SET1(st->inverse ? -1.f : 1.f);
+    int u,l;
+    for (u=0;u<m;++u) {
+        const KFB_V w1r = KFB_SET1(tw[u*fstride].r), w1i = KFB_SET1(tw[u*fstride].i);
+        const KFB_V w2r = KFB_SET1(tw[2*u*fstride].r), w2i = KFB_SET1(tw[2*u*fstride].i);
+        const KFB_V w3r = KFB_SET1(tw[3*u*fstride].r), w3i = KFB_SET1(tw[3*u*fstride].i);
+        float * r0 = re + u*KFB_L, * i0 = im + u*KFB_L;
+        float * r1 = r0 + m*KFB_L, * i1 = i0 + m*KFB_L;
+        float * r2 = r1 + m*KFB_L, * i2 = i1 + m*KFB_L;
+        float * r3 = r2 + m*KFB_L, * i3 = i2 + m*KFB_L;
+        for (l=0;l<KFB_L;l+=KFB_W) {
+            const KFB_V x0r = KFB_LOAD(r0+l), x0i = KFB_LOAD(i0+l);
+            const KFB_V x1r = KFB_LOAD(r1+l), x1i = KFB_LOAD(i1+l);
+            const KFB_V x2r = KFB_LOAD(r2+l), x2i = KFB_LOAD(i2+l);
+            const KFB_V x3r = KFB_LOAD(r3+l), x3i = KFB_LOAD(i3+l);
+            const KFB_V s0r = KFB_SUB( KFB_MUL(x1r,w1r) , KFB_MUL(x1i,w1i) ), s0i = KFB_ADD( KFB_MUL(x1r,w1i) , KFB_MUL(x1i,w1r) );
+            const KFB_V s1r = KFB_SUB( KFB_MUL(x2r,w2r) , KFB_MUL(x2i,w2i) ), s1i = KFB_ADD( KFB_MUL(x2r,w2i) , KFB_MUL(x2i,w2r) );
+            const KFB_V s2r = KFB_SUB( KFB_MUL(x3r,w3r) , KFB_MUL(x3i,w3i) ), s2i = KFB_ADD( KFB_MUL(x3r,w3i) , KFB_MUL(x3i,w3r) );
+            const KFB_V s5r = KFB_SUB(x0r,s1r), s5i = KFB_SUB(x0i,s1i);
+            const KFB_V a0r = KFB_ADD(x0r,s1r), a0i = KFB_ADD(x0i,s1i);
+            const KFB_V s3r = KFB_ADD(s0r,s2r), s3i = KFB_ADD(s0i,s2i);
+            const KFB_V s4r = KFB_MUL( KFB_SUB(s0r,s2r) , sg ), s4i = KFB_MUL( KFB_SUB(s0i,s2i) , sg );
+            KFB_STORE( r0+l , KFB_ADD(a0r,s3r) ); KFB_STORE( i0+l , KFB_ADD(a0i,s3i) );
+            KFB_STORE( r2+l , KFB_SUB(a0r,s3r) ); KFB_STORE( i2+l , KFB_SUB(a0i,s3i) );
+            KFB_STORE( r1+l , KFB_ADD(s5r,s4i) ); KFB_STORE( i1+l , KFB_SUB(s5i,s4r) );
+            KFB_STORE( r3+l , KFB_SUB(s5r,s4i) ); KFB_STORE( i3+l , KFB_ADD(s5i,s4r) );
+        }
+    }
+}
+
+static KFB_TARGET void KFB_NAME(bfly5)(float * re,float * im,const size_t fstride,const kfb_plan * st,int m)
+{
+    const kiss_fft_cpx * tw = st->twiddles;
+    const KFB_V yar = KFB_SET1(tw[fstride*m].r), yai = KFB_SET1(tw[fstride*m].i);
+    const KFB_V ybr = KFB_SET1(tw[fstride*2*m].r), ybi = KFB_SET1(tw[fstride*2*m].i);
+    int u,l;
+    for (u=0;u<m;++u) {
+        const KFB_V w1r = KFB_SET1(tw[u*fstride].r), w1i = KFB_SET1(tw[u*fstride].i);
+        const KFB_V w2r = KFB_SET1(tw[2*u*fstride].r), w2i = KFB_SET1(tw[2*u*fstride].i);
+        const KFB_V w3r = KFB_SET1(tw[3*u*fstride].r), w3i = KFB_SET1(tw[3*u*fstride].i);
+        const KFB_V w4r = KFB_SET1(tw[4*u*fstride].r), w4i = KFB_SET1(tw[4*u*fstride].i);
+        float * r0 = re + u*KFB_L, * i0 = im + u*KFB_L;
+        float * r1 = r0 + m*KFB_L, * i1 = i0 + m*KFB_L;
+        float * r2 = r1 + m*KFB_L, * i2 = i1 + m*KFB_L;
+        float * r3 = r2 + m*KFB_L, * i3 = i2 + m*KFB_L;
+        float * r4 = r3 + m*KFB_L, * i4 = i3 + m*KFB_L;
+        for (l=0;l<KFB_L;l+=KFB_W) {
+            const KFB_V s0r = KFB_LOAD(r0+l), s0i = KFB_LOAD(i0+l);
+            const KFB_V x1r = KFB_LOAD(r1+l), x1i = KFB_LOAD(i1+l);
+            const KFB_V x2r = KFB_LOAD(r2+l), x2i = KFB_LOAD(i2+l);
+            const KFB_V x3r = KFB_LOAD(r3+l), x3i = KFB_LOAD(i3+l);
+            const KFB_V x4r = KFB_LOAD(r4+l), x4i = KFB_LOAD(i4+l);
+            const KFB_V s1r = KFB_SUB( KFB_MUL(x1r,w1r) , KFB_MUL(x1i,w1i) ), s1i = KFB_ADD( KFB_MUL(x1r,w1i) , KFB_MUL(x1i,w1r) );
+            const KFB_V s2r = KFB_SUB( KFB_MUL(x2r,w2r) , KFB_MUL(x2i,w2i) ), s2i = KFB_ADD( KFB_MUL(x2r,w2i) , KFB_MUL(x2i,w2r) );
+            const KFB_V s3r = KFB_SUB( KFB_MUL(x3r,w3r) , KFB_MUL(x3i,w3i) ), s3i = KFB_ADD( KFB_MUL(x3r,w3i) , KFB_MUL(x3i,w3r) );
+            const KFB_V s4r = KFB_SUB( KFB_MUL(x4r,w4r) , KFB_MUL(x4i,w4i) ), s4i = KFB_ADD( KFB_MUL(x4r,w4i) , KFB_MUL(x4i,w4r) );
+            const KFB_V s7r = KFB_ADD(s1r,s4r), s7i = KFB_ADD(s1i,s4i);
+            const KFB_V s10r = KFB_SUB(s1r,s4r), s10i = KFB_SUB(s1i,s4i);
+            const KFB_V s8r = KFB_ADD(s2r,s3r), s8i = KFB_ADD(s2i,s3i);
+            const KFB_V s9r = KFB_SUB(s2r,s3r), s9i = KFB_SUB(s2i,s3i);
+            const KFB_V s5r = KFB_ADD( s0r , KFB_ADD( KFB_MUL(s7r,yar) , KFB_MUL(s8r,ybr) ) );
+            const KFB_V s5i = KFB_ADD( s0i , KFB_ADD( KFB_MUL(s7i,yar) , KFB_MUL(s8i,ybr) ) );
+            /* s6 = -i * (s10*ya.i + s9*yb.i); s6n is minus its imaginary part */
+            const KFB_V s6r = KFB_ADD( KFB_MUL(s10i,yai) , KFB_MUL(s9i,ybi) );
+            const KFB_V s6n = KFB_ADD( KFB_MUL(s10r,yai) , KFB_MUL(s9r,ybi) );
+            const KFB_V s11r = KFB_ADD( s0r , KFB_ADD( KFB_MUL(s7r,ybr) , KFB_MUL(s8r,yar) ) );
+            const KFB_V s11i = KFB_ADD( s0i , KFB_ADD( KFB_MUL(s7i,ybr) , KFB_MUL(s8i,yar) ) );
+            /* s12 = +i * (s10*yb.i - s9*ya.i); s12n is minus its real part */
+            const KFB_V s12n = KFB_SUB( KFB_MUL(s10i,ybi) , KFB_MUL(s9i,yai) );
+            const KFB_V s12i = KFB_SUB( KFB_MUL(s10r,ybi) , KFB_MUL(s9r,yai) );
+            KFB_STORE( r0+l , KFB_ADD( s0r , KFB_ADD(s7r,s8r) ) ); KFB_STORE( i0+l , KFB_ADD( s0i , KFB_ADD(s7i,s8i) ) );
+            KFB_STORE( r1+l , KFB_SUB(s5r,s6r) ); KFB_STORE( i1+l , KFB_ADD(s5i,s6n) );
+            KFB_STORE( r4+l , KFB_ADD(s5r,s6r) ); KFB_STORE( i4+l , KFB_SUB(s5i,s6n) );
+            KFB_STORE( r2+l , KFB_SUB(s11r,s12n) ); KFB_STORE( i2+l , KFB_ADD(s11i,s12i) );
+            KFB_STORE( r3+l , KFB_ADD(s11r,s12n) ); KFB_STORE( i3+l , KFB_SUB(s11i,s12i) );
+        }
+    }
+}
+
+/* length 8 DFT of (r[j],i[j]) in place; (e1r,e1i) and (e3r,e3i) are w^1 and w^3 of
+   the 8th root of unity, sg is 1 forward and -1 inverse */
+static KF_INLINE KFB_TARGET void KFB_NAME(dft8)(KFB_V * r,KFB_V * i,KFB_V e1r,KFB_V e1i,KFB_V e3r,KFB_V e3i,KFB_V sg)
+{
+    const KFB_V b0r = KFB_ADD(r[0],r[4]), b0i = KFB_ADD(i[0],i[4]);
+    const KFB_V b1r = KFB_SUB(r[0],r[4]), b1i = KFB_SUB(i[0],i[4]);
+    const KFB_V b2r = KFB_ADD(r[2],r[6]), b2i = KFB_ADD(i[2],i[6]);
+    const KFB_V b3r = KFB_MUL( KFB_SUB(i[2],i[6]) , sg ), b3i = KFB_MUL( KFB_SUB(r[6],r[2]) , sg );
+    const KFB_V c0r = KFB_ADD(r[1],r[5]), c0i = KFB_ADD(i[1],i[5]);
+    const KFB_V c1r = KFB_SUB(r[1],r[5]), c1i = KFB_SUB(i[1],i[5]);
+    const KFB_V c2r = KFB_ADD(r[3],r[7]), c2i = KFB_ADD(i[3],i[7]);
+    const KFB_V c3r = KFB_MUL( KFB_SUB(i[3],i[7]) , sg ), c3i = KFB_MUL( KFB_SUB(r[7],r[3]) , sg );
+    const KFB_V e0r = KFB_ADD(b0r,b2r), e0i = KFB_ADD(b0i,b2i);
+    const KFB_V e2r = KFB_SUB(b0r,b2r), e2i = KFB_SUB(b0i,b2i);
+    const KFB_V f1r = KFB_ADD(b1r,b3r), f1i = KFB_ADD(b1i,b3i);
+    const KFB_V f3r = KFB_SUB(b1r,b3r), f3i = KFB_SUB(b1i,b3i);
+    const KFB_V o0r = KFB_ADD(c0r,c2r), o0i = KFB_ADD(c0i,c2i);
+    const KFB_V d2r = KFB_SUB(c0r,c2r), d2i = KFB_SUB(c0i,c2i);
+    const KFB_V d1r = KFB_ADD(c1r,c3r), d1i = KFB_ADD(c1i,c3i);
+    const KFB_V d3r = KFB_SUB(c1r,c3r), d3i = KFB_SUB(c1i,c3i);
+    const KFB_V o1r = KFB_SUB( KFB_MUL(d1r,e1r) , KFB_MUL(d1i,e1i) ), o1i = KFB_ADD( KFB_MUL(d1r,e1i) , KFB_MUL(d1i,e1r) );
+    const KFB_V o2r = KFB_MUL(d2i,sg), o2i = KFB_MUL( KFB_SUB(KFB_SET1(0.f),d2r) , sg );
+    const KFB_V o3r = KFB_SUB( KFB_MUL(d3r,e3r) , KFB_MUL(d3i,e3i) ), o3i = KFB_ADD( KFB_MUL(d3r,e3i) , KFB_MUL(d3i,e3r) );
+    r[0] = KFB_ADD(e0r,o0r); i[0] = KFB_ADD(e0i,o0i);
+    r[4] = KFB_SUB(e0r,o0r); i[4] = KFB_SUB(e0i,o0i);
+    r[1] = KFB_ADD(f1r,o1r); i[1] = KFB_ADD(f1i,o1i);
+    r[5] = KFB_SUB(f1r,o1r); i[5] = KFB_SUB(f1i,o1i);
+    r[2] = KFB_ADD(e2r,o2r); i[2] = KFB_ADD(e2i,o2i);
+    r[6] = KFB_SUB(e2r,o2r); i[6] = KFB_SUB(e2i,o2i);
+    r[3] = KFB_ADD(f3r,o3r); i[3] = KFB_ADD(f3i,o3i);
+    r[7] = KFB_SUB(f3r,o3r); i[7] = KFB_SUB(f3i,o3i);
+}
+
+static KFB_TARGET void KFB_NAME(bfly8)(float * re,float * im,const size_t fstride,const kfb_plan * st,int m)
+{
+    const kiss_fft_cpx * tw = st->twiddles;
+    const KFB_V e1r = KFB_SET1(tw[fstride*m].r), e1i = KFB_SET1(tw[fstride*m].i);
+    const KFB_V e3r = KFB_SET1(tw[3*fstride*m].r), e3i = KFB_SET1(tw[3*fstride*m].i);
+    const KFB_V sg = KFB_SET1(st->inverse ? -1.f : 1.f);
+    KFB_V wr[8], wi[8], xr[8], xi[8];
+    int u,l,j;
+    for (u=0;u<m;++u) {
+        for (j=1;j<8;++j) {
+            wr[j] = KFB_SET1(tw[j*u*fstride].r);
+            wi[j] = KFB_SET1(tw[j*u*fstride].i);
+        }
+        for (l=0;l<KFB_L;l+=KFB_W) {
+            xr[0] = KFB_LOAD(re+u*KFB_L+l);
+            xi[0] = KFB_LOAD(im+u*KFB_L+l);
+            for (j=1;j<8;++j) {
+                const KFB_V ar = KFB_LOAD(re+(u+j*m)*KFB_L+l), ai = KFB_LOAD(im+(u+j*m)*KFB_L+l);
+                xr[j] = KFB_SUB( KFB_MUL(ar,wr[j]) , KFB_MUL(ai,wi[j]) );
+                xi[j] = KFB_ADD( KFB_MUL(ar,wi[j]) , KFB_MUL(ai,wr[j]) );
+            }
+            KFB_NAME(dft8)(xr,xi,e1r,e1i,e3r,e3i,sg);
+            for (j=0;j<8;++j) {
+                KFB_STORE( re+(u+j*m)*KFB_L+l , xr[j] );
+                KFB_STORE( im+(u+j*m)*KFB_L+l , xi[j] );
+            }
+        }
+    }
+}
+
+static KFB_TARGET void KFB_NAME(bfly_generic)(float * re,float * im,const size_t fstride,const kfb_plan * st,int m,int p)
+{
+    const kiss_fft_cpx * tw = st->twiddles;
+    float * sr = st->scratch;
+    float * si = sr + p*KFB_L;
+    int u,k,q1,q,l;
+    for (u=0;u<m;++u) {
+        for (q1=0;q1<p;++q1) {
+            k = u + q1*m;
+            for (l=0;l<KFB_L;l+=KFB_W) {
+                KFB_STORE( sr+q1*KFB_L+l , KFB_LOAD(re+k*KFB_L+l) );
+                KFB_STORE( si+q1*KFB_L+l , KFB_LOAD(im+k*KFB_L+l) );
+            }
+        }
+        for (q1=0;q1<p;++q1) {
+            float * r = re + (u + q1*m)*KFB_L, * i = im + (u + q1*m)*KFB_L;
+            int twidx;
+            k = u + q1*m;
+            for (l=0;l<KFB_L;l+=KFB_W) {
+                KFB_V ar = KFB_LOAD(sr+l), ai = KFB_LOAD(si+l);
+                twidx = 0;
+                for (q=1;q<p;++q) {
+                    KFB_V wr,wi,xr,xi;
+                    twidx += (int)fstride * k;
+                    if (twidx >= st->nfft) twidx -= st->nfft;
+                    wr = KFB_SET1(tw[twidx].r); wi = KFB_SET1(tw[twidx].i);
+                    xr = KFB_LOAD(sr+q*KFB_L+l); xi = KFB_LOAD(si+q*KFB_L+l);
+                    ar = KFB_ADD( ar , KFB_SUB( KFB_MUL(xr,wr) , KFB_MUL(xi,wi) ) );
+                    ai = KFB_ADD( ai , KFB_ADD( KFB_MUL(xr,wi) , KFB_MUL(xi,wr) ) );
+                }
+                KFB_STORE( r+l , ar ); KFB_STORE( i+l , ai );
+            }
+        }
+    }
+}
+
+static KFB_TARGET void KFB_NAME(work)(
+        float * Fre,float * Fim,
+        const float * fre,const float * fim,
+        const size_t fstride,
+        const int * factors,
+        const kfb_plan * st
+        )
+{
+    const int p = *factors++;
+    const int m = *factors++;
+    int j,l;
+
+    if (m == 1) {
+        for (j=0;j<p;++j) {
+            const float * r = fre + j*fstride*KFB_L, * i = fim + j*fstride*KFB_L;
+            for (l=0;l<KFB_L;l+=KFB_W) {
+                KFB_STORE( Fre+j*KFB_L+l , KFB_LOAD(r+l) );
+                KFB_STORE( Fim+j*KFB_L+l , KFB_LOAD(i+l) );
+            }
+        }
+    } else {
+        for (j=0;j<p;++j)
+            KFB_NAME(work)( Fre + j*m*KFB_L , Fim + j*m*KFB_L ,
+                    fre + j*fstride*KFB_L , fim + j*fstride*KFB_L , fstride*p , factors , st );
+    }
+
+    switch (p) {
+        case 2: KFB_NAME(bfly2)(Fre,Fim,fstride,st,m); break;
+        case 3: KFB_NAME(bfly3)(Fre,Fim,fstride,st,m); break;
+        case 4: KFB_NAME(bfly4)(Fre,Fim,fstride,st,m); break;
+        case 5: KFB_NAME(bfly5)(Fre,Fim,fstride,st,m); break;
+        case 8: KFB_NAME(bfly8)(Fre,Fim,fstride,st,m); break;
+        default: KFB_NAME(bfly_generic)(Fre,Fim,fstride,st,m,p); break;
+    }
+}
+
+static KFB_TARGET void KFB_NAME(fft)(const kfb_plan * st,const float * fre,const float * fim,float * Fre,float * Fim)
+{
+    KFB_NAME(work)(Fre,Fim,fre,fim,1,st->factors,st);
+}
+
+/* kiss_fftr's post-processing: packed spectrum (fre,fim) to half spectra (Xre,Xim), ncfft+1 bins */
+static KFB_TARGET void KFB_NAME(split)(const kiss_fft_cpx * super_twiddles,int ncfft,
+        const float * fre,const float * fim,float * Xre,float * Xim)
+{
+    const KFB_V half = KFB_SET1(.5f), zero = KFB_SET1(0.f);
+    int k,l;
+    for (l=0;l<KFB_L;l+=KFB_W) {
+        const KFB_V dr = KFB_LOAD(fre+l), di = KFB_LOAD(fim+l);
+        KFB_STORE( Xre+l , KFB_ADD(dr,di) );
+        KFB_STORE( Xre+ncfft*KFB_L+l , KFB_SUB(dr,di) );
+        KFB_STORE( Xim+l , zero );
+        KFB_STORE( Xim+ncfft*KFB_L+l , zero );
+    }
+    /* k < ncfft-k here, so the two rows never overlap */
+    for (k=1;2*k<ncfft;++k) {
+        const KFB_V wr = KFB_SET1(super_twiddles[k-1].r), wi = KFB_SET1(super_twiddles[k-1].i);
+        const float * pr = fre + k*KFB_L, * pi = fim + k*KFB_L;
+        const float * nr = fre + (ncfft-k)*KFB_L, * ni = fim + (ncfft-k)*KFB_L;
+        float * Xpr = Xre + k*KFB_L, * Xpi = Xim + k*KFB_L;
+        float * Xnr = Xre + (ncfft-k)*KFB_L, * Xni = Xim + (ncfft-k)*KFB_L;
+        for (l=0;l<KFB_L;l+=KFB_W) {
+            const KFB_V ar = KFB_LOAD(pr+l), ai = KFB_LOAD(pi+l);
+            const KFB_V br = KFB_LOAD(nr+l), bi = KFB_LOAD(ni+l);
+            const KFB_V f1r = KFB_ADD(ar,br), f1i = KFB_SUB(ai,bi);
+            const KFB_V f2r = KFB_SUB(ar,br), f2i = KFB_ADD(ai,bi);
+            const KFB_V tr = KFB_SUB( KFB_MUL(f2r,wr) , KFB_MUL(f2i,wi) );
+            const KFB_V ti = KFB_ADD( KFB_MUL(f2r,wi) , KFB_MUL(f2i,wr) );
+            KFB_STORE( Xpr+l , KFB_MUL( KFB_ADD(f1r,tr) , half ) );
+            KFB_STORE( Xpi+l , KFB_MUL( KFB_ADD(f1i,ti) , half ) );
+            KFB_STORE( Xnr+l , KFB_MUL( KFB_SUB(f1r,tr) , half ) );
+            KFB_STORE( Xni+l , KFB_MUL( KFB_SUB(ti,f1i) , half ) );
+        }
+    }
+    if (ncfft > 1 && 2*k == ncfft) {
+        /* middle bin: its own mirror, only the imaginary part flips */
+        for (l=0;l<KFB_L;l+=KFB_W) {
+            KFB_STORE( Xre+k*KFB_L+l , KFB_LOAD(fre+k*KFB_L+l) );
+            KFB_STORE( Xim+k*KFB_L+l , KFB_SUB( zero , KFB_LOAD(fim+k*KFB_L+l) ) );
+        }
+    }
+}
+
+/* kiss_fftri's pre-processing: half spectra (Xre,Xim) to packed spectrum (fre,fim) */
+static KFB_TARGET void KFB_NAME(merge)(const kiss_fft_cpx * super_twiddles,int ncfft,
+        const float * Xre,const float * Xim,float * fre,float * fim)
+{
+    const KFB_V two = KFB_SET1(2.f), mtwo = KFB_SET1(-2.f);
+    int k,l;
+    for (l=0;l<KFB_L;l+=KFB_W) {
+        const KFB_V dr = KFB_LOAD(Xre+l), nr = KFB_LOAD(Xre+ncfft*KFB_L+l);
+        KFB_STORE( fre+l , KFB_ADD(dr,nr) );
+        KFB_STORE( fim+l , KFB_SUB(dr,nr) );
+    }
+    for (k=1;2*k<ncfft;++k) {
+        const KFB_V wr = KFB_SET1(super_twiddles[k-1].r), wi = KFB_SET1(super_twiddles[k-1].i);
+        const float * pr = Xre + k*KFB_L, * pi = Xim + k*KFB_L;
+        const float * nr = Xre + (ncfft-k)*KFB_L, * ni = Xim + (ncfft-k)*KFB_L;
+        float * fpr = fre + k*KFB_L, * fpi = fim + k*KFB_L;
+        float * fnr = fre + (ncfft-k)*KFB_L, * fni = fim + (ncfft-k)*KFB_L;
+        for (l=0;l<KFB_L;l+=KFB_W) {
+            const KFB_V ar = KFB_LOAD(pr+l), ai = KFB_LOAD(pi+l);
+            const KFB_V br = KFB_LOAD(nr+l), bi = KFB_LOAD(ni+l);
+            const KFB_V ekr = KFB_ADD(ar,br), eki = KFB_SUB(ai,bi);
+            const KFB_V tr = KFB_SUB(ar,br), ti = KFB_ADD(ai,bi);
+            const KFB_V okr = KFB_SUB( KFB_MUL(tr,wr) , KFB_MUL(ti,wi) );
+            const KFB_V oki = KFB_ADD( KFB_MUL(tr,wi) , KFB_MUL(ti,wr) );
+            KFB_STORE( fpr+l , KFB_ADD(ekr,okr) );
+            KFB_STORE( fpi+l , KFB_ADD(eki,oki) );
+            KFB_STORE( fnr+l , KFB_SUB(ekr,okr) );
+            KFB_STORE( fni+l , KFB_SUB(oki,eki) );
+        }
+    }
+    if (ncfft > 1 && 2*k == ncfft) {
+        for (l=0;l<KFB_L;l+=KFB_W) {
+            KFB_STORE( fre+k*KFB_L+l , KFB_MUL( KFB_LOAD(Xre+k*KFB_L+l) , two ) );
+            KFB_STORE( fim+k*KFB_L+l , KFB_MUL( KFB_LOAD(Xim+k*KFB_L+l) , mtwo ) );
+        }
+    }
+}
+
+static const kfb_impl KFB_NAME(impl) = { KFB_NAME(fft), KFB_NAME(split), KFB_NAME(merge) };
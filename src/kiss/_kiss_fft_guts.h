@@ -16,22 +16,175 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
    defines kiss_fft_scalar as either short or a float type
    and defines
    typedef struct { kiss_fft_scalar r; kiss_fft_scalar i; }kiss_fft_cpx; */
+#ifndef _KISS_FFT_GUTS_H
+#define _KISS_FFT_GUTS_H
+
 #include "kiss_fft.h"
 #include <limits.h>
 
 #define MAXFACTORS 32
-/* e.g. an fft of length 128 has 4 factors 
+/* e.g. an fft of length 128 has 3 factors 
  as far as kissfft is concerned
- 4*4*4*2
+ 8*8*2
  */
 
+/* one pass of the iterative executor: radix p, m = remaining length / p,
+   s = product of the radices of the passes before it */
+typedef struct {
+    int p;
+    int m;
+    int s;
+} kf_stage;
+
+/* Bluestein plan for one large prime radix p: the length p DFT is
+   computed as a circular convolution of length L, a power of two
+   no smaller than 2p-1 */
+typedef struct {
+    int p;
+    int L;
+    kiss_fft_cfg fft;       /* forward transform of length L */
+    kiss_fft_cpx * chirp;   /* w^(k*k/2) of the p-th root of unity, k=0..p-1 */
+    kiss_fft_cpx * filter;  /* FFT of the conjugate chirp, scaled by 1/L */
+} kf_bluestein;
+
+/* prime radices of at least KISS_FFT_BLUESTEIN_MIN use Bluestein's
+   algorithm instead of the O(p^2) generic butterfly. The fixed point
+   build keeps the generic butterfly, because the three scaled
+   transforms of the convolution would lose too many bits. */
+#if !defined(FIXED_POINT) && !defined(USE_SIMD)
+#  define KISS_FFT_HAVE_BLUESTEIN 1
+#  ifndef KISS_FFT_BLUESTEIN_MIN
+#    define KISS_FFT_BLUESTEIN_MIN 29
+#  endif
+#endif
+
 struct kiss_fft_state{
     int nfft;
     int inverse;
+    int simd; /* highest KISS_FFT_SIMD_* level the butterflies may use */
+    int executor; /* KISS_FFT_EXEC_* */
+    int nstages;
+    kf_stage stages[MAXFACTORS];
+    kiss_fft_cpx * work; /* 2*nfft + nscratch points after the twiddles, see kf_stride_work */
+    int nscratch; /* points of butterfly scratch for the generic and Bluestein radices */
+    int nbluestein;
+    kf_bluestein * bluestein; /* one per distinct large prime factor, after the work buffers */
+    struct kiss_fft_state * sixstep[2]; /* row plans of length n1 and n2 = nfft/n1 for the six-step executor, or NULL */
     int factors[2*MAXFACTORS];
     kiss_fft_cpx twiddles[1];
 };
 
+/*
+  Vectorized butterflies (see kiss_fft_simd.c).
+
+  Each kernel set has the same signature and semantics as the scalar
+  kf_bfly2/3/4/5/8 in kiss_fft.c, but processes 'width' consecutive
+  butterflies of one stage per iteration, so it may only be used when
+  m is a multiple of width.
+ */
+#if !defined(FIXED_POINT) && !defined(USE_SIMD) && !defined(KISS_FFT_NO_SIMD) && \
+    ( defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64) )
+#  define KISS_FFT_HAVE_X86_SIMD 1
+#endif
+
+/* butterflies u0 <= u < u1 of a radix recombination; u0 and u1 must be multiples of width */
+typedef void (*kf_bfly_fn)(kiss_fft_cpx * Fout,const size_t fstride,const kiss_fft_cfg st,int m,int u0,int u1);
+
+/* Stockham stage from x to y (unit stride); needs s to be a multiple of width */
+typedef void (*kf_stage_fn)(const kiss_fft_cpx * x,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg);
+
+typedef struct {
+    int level;
+    int width;
+    kf_bfly_fn bfly2;
+    kf_bfly_fn bfly3;
+    kf_bfly_fn bfly4;
+    kf_bfly_fn bfly5;
+    kf_bfly_fn bfly8;
+    kf_stage_fn stage2;
+    kf_stage_fn stage3;
+    kf_stage_fn stage4;
+    kf_stage_fn stage5;
+    kf_stage_fn stage8;
+} kf_simd_kernels;
+
+/* highest level supported by both this build and the running cpu */
+int kf_simd_detect(void);
+
+/* widest kernel set allowed by 'level' whose width divides m, or NULL */
+const kf_simd_kernels * kf_simd_select(int level,int m);
+
+/* for the small DFT helpers shared by several butterflies; their
+   complex temporaries must stay in registers */
+#if defined(_MSC_VER)
+#  define KF_INLINE __forceinline
+#elif defined(__GNUC__)
+#  define KF_INLINE __inline__ __attribute__((always_inline))
+#else
+#  define KF_INLINE
+#endif
+
+/* tw[j] = exp(-2*pi*i*(first+j)/n) for j < count, or exp(+...) when inverse,
+   with 0 <= first and first+count <= n. Only the angles of one octant are
+   evaluated; the rest of the range is filled from them by symmetry. */
+void kf_twiddles(kiss_fft_cpx * tw,int n,int first,int count,int inverse);
+
+/* factors n into p1,m1,p2,m2,... as used by kf_work (kiss_fft.c) */
+void kf_factor(int n,int * facbuf);
+
+/* radix order of kf_factor_order; kf_factor uses KF_ORDER_RADIX8 */
+#define KF_ORDER_RADIX8 0 /* 8s, then 4, 2 and the odd primes */
+#define KF_ORDER_RADIX4 1 /* 4s, then 2 and the odd primes */
+void kf_factor_order(int n,int * facbuf,int order);
+
+/* a plan chosen by the measuring planner (kiss_fft_wisdom.c) */
+typedef struct {
+    int order;    /* KF_ORDER_* */
+    int executor; /* KISS_FFT_EXEC_* */
+    int simd;     /* KISS_FFT_SIMD_* */
+} kf_tuning;
+
+/* kiss_fft_alloc with the given plan, or the default one if tuning is NULL */
+kiss_fft_cfg kf_alloc_tuned(int nfft,int inverse_fft,void * mem,size_t * lenmem,const kf_tuning * tuning);
+
+/* 1 and the recorded plan if there is wisdom for nfft; tuning may be
+   NULL. Takes no lock, so it may run on a real-time thread */
+int kf_wisdom_lookup(int nfft,int inverse_fft,kf_tuning * tuning);
+
+/* forgets all wisdom and frees every entry, retired ones included;
+   nothing may be planning at the same time */
+void kf_wisdom_release(void);
+
+/* kiss_fft_stride, with its work space supplied by the caller instead of
+   taken from the cfg: 2*nfft points for the stockham ping-pong buffers or
+   the in-place copy of the recursive executor, then nscratch points for
+   the butterflies */
+void kf_stride_work(const kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int in_stride,kiss_fft_cpx * work);
+
+/* smallest nfft kiss_fft_alloc plans for the six-step executor */
+#ifndef KISS_FFT_SIXSTEP_MIN
+#  define KISS_FFT_SIXSTEP_MIN (1<<20)
+#endif
+
+/* smallest nfft the parallel executor splits between threads */
+#ifndef KISS_FFT_PARALLEL_MIN
+#  define KISS_FFT_PARALLEL_MIN 65536
+#endif
+
+/* worker pool of the parallel executor (kiss_fft_pool.c).
+   kf_pool_run calls fn(arg,task,worker) once for every task in [0,ntasks)
+   and returns when all have finished. worker identifies the calling
+   thread, 0 for the caller of kf_pool_run, and stays below maxthreads,
+   so tasks can index per-thread scratch with it. */
+typedef void (*kf_pool_fn)(void * arg,int task,int worker);
+void kf_pool_run(kf_pool_fn fn,void * arg,int ntasks,int maxthreads);
+/* threads kf_pool_run spreads tasks over, the caller included */
+int kf_pool_size(void);
+/* starts the workers unless they are running; called at plan time, as
+   kf_pool_run never starts them */
+void kf_pool_prepare(void);
+void kf_pool_shutdown(void);
+
 /*
   Explanation of macros dealing with complex math:
 
@@ -124,19 +277,19 @@ struct kiss_fft_state{
     }while(0)
 
 
+/* KF_TRIG converts a cosine or sine, in double, to a kiss_fft_scalar */
 #ifdef FIXED_POINT
-#  define KISS_FFT_COS(phase)  floor(.5+SAMP_MAX * cos (phase))
-#  define KISS_FFT_SIN(phase)  floor(.5+SAMP_MAX * sin (phase))
+#  define KF_TRIG(x) floor(.5+SAMP_MAX * (x))
 #  define HALF_OF(x) ((x)>>1)
 #elif defined(USE_SIMD)
-#  define KISS_FFT_COS(phase) _mm_set1_ps( cos(phase) )
-#  define KISS_FFT_SIN(phase) _mm_set1_ps( sin(phase) )
+#  define KF_TRIG(x) _mm_set1_ps( (float)(x) )
 #  define HALF_OF(x) ((x)*_mm_set1_ps(.5))
 #else
-#  define KISS_FFT_COS(phase) (kiss_fft_scalar) cos(phase)
-#  define KISS_FFT_SIN(phase) (kiss_fft_scalar) sin(phase)
+#  define KF_TRIG(x) (kiss_fft_scalar) (x)
 #  define HALF_OF(x) ((x)*.5)
 #endif
+#define KISS_FFT_COS(phase) KF_TRIG( cos(phase) )
+#define KISS_FFT_SIN(phase) KF_TRIG( sin(phase) )
 
 #define  kf_cexp(x,phase) \
 	do{ \
@@ -150,15 +303,31 @@ struct kiss_fft_state{
     fprintf(stderr,"%g + %gi\n",(double)((c)->r),(double)((c)->i) )
 
 
-#ifdef KISS_FFT_USE_ALLOCA
-// define this to allow use of alloca instead of malloc for temporary buffers
-// Temporary buffers are used in two case: 
-// 1. FFT sizes that have "bad" factors. i.e. not 2,3 and 5
-// 2. "in-place" FFTs.  Notice the quotes, since kissfft does not really do an in-place transform.
-#include <alloca.h>
-#define  KISS_FFT_TMP_ALLOC(nbytes) alloca(nbytes)
-#define  KISS_FFT_TMP_FREE(ptr) 
+/*
+ Transforms never allocate: every buffer they use is reserved by the
+ alloc functions, in the cfg or in the caller's scratch.
+
+ Building with KISS_FFT_CHECK_ALLOC turns that into a debug assertion:
+ the transform entry points count themselves in a thread local depth,
+ and every allocation the library makes through KF_MALLOC asserts that
+ the depth is zero.
+ */
+#ifdef KISS_FFT_CHECK_ALLOC
+#  include <assert.h>
+#  if defined(_MSC_VER)
+#    define KF_THREAD_LOCAL __declspec(thread)
+#  else
+#    define KF_THREAD_LOCAL __thread
+#  endif
+extern KF_THREAD_LOCAL int kf_transform_depth;
+#  define KF_TRANSFORM_ENTER() (++kf_transform_depth)
+#  define KF_TRANSFORM_LEAVE() (--kf_transform_depth)
+#  define KF_MALLOC(nbytes) \
+    ( assert(kf_transform_depth == 0 && "kiss_fft allocation inside a transform") , kiss_fft_malloc(nbytes) )
 #else
-#define  KISS_FFT_TMP_ALLOC(nbytes) KISS_FFT_MALLOC(nbytes)
-#define  KISS_FFT_TMP_FREE(ptr) KISS_FFT_FREE(ptr)
+#  define KF_TRANSFORM_ENTER() ((void)0)
+#  define KF_TRANSFORM_LEAVE() ((void)0)
+#  define KF_MALLOC(nbytes) kiss_fft_malloc(nbytes)
+#endif
+
 #endif
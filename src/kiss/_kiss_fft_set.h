@@ -0,0 +1,88 @@
+#ifndef _KISS_FFT_SET_H
+#define _KISS_FFT_SET_H
+
+/*
+ Configuration of an extra symbol set (see kiss_fft_sets.h), included by
+ kiss_fft_f64.c and kiss_fft_s16.c before any other kiss header. It
+ fixes kiss_fft_scalar for the set, whatever the build defines, and
+ renames every external name of the core, so the set links next to the
+ default one. The worker pool and the allocator hooks are not part of
+ any set: kf_pool_*, kiss_fft_set_threads, kiss_fft_set_allocator,
+ kiss_fft_malloc and kiss_fft_free are shared by all of them.
+ */
+
+/* the set builds kiss_fft_wisdom.c into the same translation unit, so
+   its feature test macro has to come before any system header */
+#if !defined(_MSC_VER) && !defined(_POSIX_C_SOURCE)
+#  define _POSIX_C_SOURCE 200112L
+#endif
+
+#undef FIXED_POINT
+#undef USE_SIMD
+#undef kiss_fft_scalar
+
+#if defined(KISS_FFT_SET_F64)
+#  define kiss_fft_scalar double
+/* the vector kernels are float only */
+#  ifndef KISS_FFT_NO_SIMD
+#    define KISS_FFT_NO_SIMD
+#  endif
+#  define KF_SET(name) name##_f64
+#elif defined(KISS_FFT_SET_S16)
+#  define FIXED_POINT 16
+#  define KF_SET(name) name##_s16
+#else
+#  error "define KISS_FFT_SET_F64 or KISS_FFT_SET_S16"
+#endif
+
+/* types */
+#define kiss_fft_cpx KF_SET(kiss_fft_cpx)
+#define kiss_fft_cfg KF_SET(kiss_fft_cfg)
+#define kiss_fft_state KF_SET(kiss_fft_state)
+#define kiss_fftr_cfg KF_SET(kiss_fftr_cfg)
+#define kiss_fftr_state KF_SET(kiss_fftr_state)
+
+/* kiss_fft.h */
+#define kiss_fft_alloc KF_SET(kiss_fft_alloc)
+#define kiss_fft KF_SET(kiss_fft)
+#define kiss_fft_stride KF_SET(kiss_fft_stride)
+#define kiss_fft_scratch_size KF_SET(kiss_fft_scratch_size)
+#define kiss_fft_scratch KF_SET(kiss_fft_scratch)
+#define kiss_fft_simd_level KF_SET(kiss_fft_simd_level)
+#define kiss_fft_set_simd_level KF_SET(kiss_fft_set_simd_level)
+#define kiss_fft_set_executor KF_SET(kiss_fft_set_executor)
+#define kiss_fft_alloc_measured KF_SET(kiss_fft_alloc_measured)
+#define kiss_fft_export_wisdom KF_SET(kiss_fft_export_wisdom)
+#define kiss_fft_import_wisdom KF_SET(kiss_fft_import_wisdom)
+#define kiss_fft_forget_wisdom KF_SET(kiss_fft_forget_wisdom)
+#define kiss_fft_cleanup KF_SET(kiss_fft_cleanup)
+#define kiss_fft_next_fast_size KF_SET(kiss_fft_next_fast_size)
+
+/* kiss_fftr.h */
+#define kiss_fftr_alloc KF_SET(kiss_fftr_alloc)
+#define kiss_fftr KF_SET(kiss_fftr)
+#define kiss_fftri KF_SET(kiss_fftri)
+#define kiss_fftr_scratch_size KF_SET(kiss_fftr_scratch_size)
+#define kiss_fftr_scratch KF_SET(kiss_fftr_scratch)
+#define kiss_fftri_scratch KF_SET(kiss_fftri_scratch)
+
+/* kfc.h */
+#define kfc_acquire KF_SET(kfc_acquire)
+#define kfc_release KF_SET(kfc_release)
+#define kfc_acquire_real KF_SET(kfc_acquire_real)
+#define kfc_release_real KF_SET(kfc_release_real)
+#define kfc_cleanup KF_SET(kfc_cleanup)
+
+/* _kiss_fft_guts.h */
+#define kf_factor KF_SET(kf_factor)
+#define kf_factor_order KF_SET(kf_factor_order)
+#define kf_twiddles KF_SET(kf_twiddles)
+#define kf_alloc_tuned KF_SET(kf_alloc_tuned)
+#define kf_wisdom_lookup KF_SET(kf_wisdom_lookup)
+#define kf_wisdom_release KF_SET(kf_wisdom_release)
+#define kf_stride_work KF_SET(kf_stride_work)
+#define kf_simd_detect KF_SET(kf_simd_detect)
+#define kf_simd_select KF_SET(kf_simd_select)
+#define kf_transform_depth KF_SET(kf_transform_depth)
+
+#endif
@@ -0,0 +1,333 @@
+/*
+ Butterfly bodies shared by the SSE2, AVX2 and AVX-512 kernels in kiss_fft_simd.c.
+
+ This file is included once per instruction set, after defining:
+
+   KF_V                 vector type holding KF_W interleaved complex values
+   KF_LEVEL             KISS_FFT_SIMD_* level of the instruction set
+   KF_W                 complex values per vector
+   KF_NAME(x)           kernel name for this instruction set
+   KF_TARGET            function attribute enabling the instruction set
+   KF_LOAD(p)           unaligned load of KF_W values starting at p
+   KF_STORE(p,v)        unaligned store
+   KF_LOADTW(p,s)       load p[0], p[s], ... p[(KF_W-1)*s]
+   KF_BCAST(p)          broadcast the complex value *p to every slot
+   KF_ADD(a,b), KF_SUB(a,b)
+   KF_SCALE(a,s)        multiply both parts by the float s
+   KF_CMUL(a,b)         complex multiply
+   KF_MULNI(a)          multiply by -i
+   KF_MULPI(a)          multiply by +i
+
+ Each kernel is the vector form of the scalar butterfly of the same
+ radix in kiss_fft.c, runs the butterflies u0 <= k < u1 and expects m,
+ u0 and u1 to be multiples of KF_W. The stage
+ kernels are the vector forms of the Stockham stages kf_stage2/3/4/5/8 and
+ expect s to be a multiple of KF_W; their twiddle is constant along q,
+ so it is a broadcast rather than a gather.
+ */
+
+static KF_TARGET void KF_NAME(bfly2)(
+        kiss_fft_cpx * Fout,
+        const size_t fstride,
+        const kiss_fft_cfg st,
+        int m,
+        int u0,
+        int u1
+        )
+{
+    const kiss_fft_cpx * tw = st->twiddles;
+    kiss_fft_cpx * Fout2 = Fout + m;
+    int k;
+
+    for (k=u0;k<u1;k+=KF_W) {
+        KF_V a = KF_LOAD(Fout+k);
+        KF_V t = KF_CMUL( KF_LOAD(Fout2+k) , KF_LOADTW(tw+k*fstride,fstride) );
+        KF_STORE( Fout2+k , KF_SUB(a,t) );
+        KF_STORE( Fout+k , KF_ADD(a,t) );
+    }
+}
+
+static KF_TARGET void KF_NAME(bfly3)(
+        kiss_fft_cpx * Fout,
+        const size_t fstride,
+        const kiss_fft_cfg st,
+        int m,
+        int u0,
+        int u1
+        )
+{
+    const kiss_fft_cpx * tw = st->twiddles;
+    const float epi3i = st->twiddles[fstride*m].i;
+    int k;
+
+    for (k=u0;k<u1;k+=KF_W) {
+        KF_V f0 = KF_LOAD(Fout+k);
+        KF_V s1 = KF_CMUL( KF_LOAD(Fout+m+k) , KF_LOADTW(tw+k*fstride,fstride) );
+        KF_V s2 = KF_CMUL( KF_LOAD(Fout+2*m+k) , KF_LOADTW(tw+2*k*fstride,2*fstride) );
+        KF_V s3 = KF_ADD(s1,s2);
+        KF_V s0 = KF_SCALE( KF_SUB(s1,s2) , epi3i );
+        KF_V f1 = KF_SUB( f0 , KF_SCALE(s3,.5f) );
+
+        KF_STORE( Fout+k , KF_ADD(f0,s3) );
+        KF_STORE( Fout+2*m+k , KF_ADD( f1 , KF_MULNI(s0) ) );
+        KF_STORE( Fout+m+k , KF_ADD( f1 , KF_MULPI(s0) ) );
+    }
+}
+
+static KF_TARGET void KF_NAME(bfly4)(
+        kiss_fft_cpx * Fout,
+        const size_t fstride,
+        const kiss_fft_cfg st,
+        int m,
+        int u0,
+        int u1
+        )
+{
+    const kiss_fft_cpx * tw = st->twiddles;
+    int k;
+
+    for (k=u0;k<u1;k+=KF_W) {
+        KF_V f0 = KF_LOAD(Fout+k);
+        KF_V s0 = KF_CMUL( KF_LOAD(Fout+m+k) , KF_LOADTW(tw+k*fstride,fstride) );
+        KF_V s1 = KF_CMUL( KF_LOAD(Fout+2*m+k) , KF_LOADTW(tw+2*k*fstride,2*fstride) );
+        KF_V s2 = KF_CMUL( KF_LOAD(Fout+3*m+k) , KF_LOADTW(tw+3*k*fstride,3*fstride) );
+        KF_V s5 = KF_SUB(f0,s1);
+        KF_V s4 = KF_SUB(s0,s2);
+        KF_V s3 = KF_ADD(s0,s2);
+
+        f0 = KF_ADD(f0,s1);
+        KF_STORE( Fout+2*m+k , KF_SUB(f0,s3) );
+        KF_STORE( Fout+k , KF_ADD(f0,s3) );
+
+        s4 = st->inverse ? KF_MULPI(s4) : KF_MULNI(s4);
+        KF_STORE( Fout+m+k , KF_ADD(s5,s4) );
+        KF_STORE( Fout+3*m+k , KF_SUB(s5,s4) );
+    }
+}
+
+static KF_TARGET void KF_NAME(bfly5)(
+        kiss_fft_cpx * Fout,
+        const size_t fstride,
+        const kiss_fft_cfg st,
+        int m,
+        int u0,
+        int u1
+        )
+{
+    const kiss_fft_cpx * tw = st->twiddles;
+    const kiss_fft_cpx ya = st->twiddles[fstride*m];
+    const kiss_fft_cpx yb = st->twiddles[fstride*2*m];
+    int k;
+
+    for (k=u0;k<u1;k+=KF_W) {
+        KF_V s0 = KF_LOAD(Fout+k);
+        KF_V s1 = KF_CMUL( KF_LOAD(Fout+m+k) , KF_LOADTW(tw+k*fstride,fstride) );
+        KF_V s2 = KF_CMUL( KF_LOAD(Fout+2*m+k) , KF_LOADTW(tw+2*k*fstride,2*fstride) );
+        KF_V s3 = KF_CMUL( KF_LOAD(Fout+3*m+k) , KF_LOADTW(tw+3*k*fstride,3*fstride) );
+        KF_V s4 = KF_CMUL( KF_LOAD(Fout+4*m+k) , KF_LOADTW(tw+4*k*fstride,4*fstride) );
+        KF_V s7 = KF_ADD(s1,s4);
+        KF_V s10 = KF_SUB(s1,s4);
+        KF_V s8 = KF_ADD(s2,s3);
+        KF_V s9 = KF_SUB(s2,s3);
+        KF_V s5 = KF_ADD( s0 , KF_ADD( KF_SCALE(s7,ya.r) , KF_SCALE(s8,yb.r) ) );
+        KF_V s6 = KF_MULNI( KF_ADD( KF_SCALE(s10,ya.i) , KF_SCALE(s9,yb.i) ) );
+        KF_V s11 = KF_ADD( s0 , KF_ADD( KF_SCALE(s7,yb.r) , KF_SCALE(s8,ya.r) ) );
+        KF_V s12 = KF_MULPI( KF_SUB( KF_SCALE(s10,yb.i) , KF_SCALE(s9,ya.i) ) );
+
+        KF_STORE( Fout+k , KF_ADD( s0 , KF_ADD(s7,s8) ) );
+        KF_STORE( Fout+m+k , KF_SUB(s5,s6) );
+        KF_STORE( Fout+4*m+k , KF_ADD(s5,s6) );
+        KF_STORE( Fout+2*m+k , KF_ADD(s11,s12) );
+        KF_STORE( Fout+3*m+k , KF_SUB(s11,s12) );
+    }
+}
+
+/* length 8 DFT of a[0..7] in place; e1 and e3 hold w^1 and w^3 of the 8th root of unity */
+static KF_INLINE KF_TARGET void KF_NAME(dft8)(KF_V * a,KF_V e1,KF_V e3,int inverse)
+{
+    KF_V b0 = KF_ADD(a[0],a[4]), b1 = KF_SUB(a[0],a[4]);
+    KF_V b2 = KF_ADD(a[2],a[6]), b3 = KF_SUB(a[2],a[6]);
+    KF_V c0 = KF_ADD(a[1],a[5]), c1 = KF_SUB(a[1],a[5]);
+    KF_V c2 = KF_ADD(a[3],a[7]), c3 = KF_SUB(a[3],a[7]);
+    KF_V e0,e1_,e2,e3_,o0,o1,o2,o3;
+
+    b3 = inverse ? KF_MULPI(b3) : KF_MULNI(b3);
+    c3 = inverse ? KF_MULPI(c3) : KF_MULNI(c3);
+    e0 = KF_ADD(b0,b2); e2 = KF_SUB(b0,b2);
+    e1_ = KF_ADD(b1,b3); e3_ = KF_SUB(b1,b3);
+    o0 = KF_ADD(c0,c2); o2 = KF_SUB(c0,c2);
+    o1 = KF_CMUL( KF_ADD(c1,c3) , e1 );
+    o3 = KF_CMUL( KF_SUB(c1,c3) , e3 );
+    o2 = inverse ? KF_MULPI(o2) : KF_MULNI(o2);
+
+    a[0] = KF_ADD(e0,o0); a[4] = KF_SUB(e0,o0);
+    a[1] = KF_ADD(e1_,o1); a[5] = KF_SUB(e1_,o1);
+    a[2] = KF_ADD(e2,o2); a[6] = KF_SUB(e2,o2);
+    a[3] = KF_ADD(e3_,o3); a[7] = KF_SUB(e3_,o3);
+}
+
+static KF_TARGET void KF_NAME(bfly8)(
+        kiss_fft_cpx * Fout,
+        const size_t fstride,
+        const kiss_fft_cfg st,
+        int m,
+        int u0,
+        int u1
+        )
+{
+    const kiss_fft_cpx * tw = st->twiddles;
+    const KF_V e1 = KF_BCAST(tw+fstride*m);
+    const KF_V e3 = KF_BCAST(tw+3*fstride*m);
+    KF_V a[8];
+    int k,j;
+
+    for (k=u0;k<u1;k+=KF_W) {
+        a[0] = KF_LOAD(Fout+k);
+        for (j=1;j<8;++j)
+            a[j] = KF_CMUL( KF_LOAD(Fout+j*m+k) , KF_LOADTW(tw+j*k*fstride,j*fstride) );
+        KF_NAME(dft8)(a,e1,e3,st->inverse);
+        for (j=0;j<8;++j)
+            KF_STORE( Fout+j*m+k , a[j] );
+    }
+}
+
+static KF_TARGET void KF_NAME(stage2)(const kiss_fft_cpx * x,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg)
+{
+    const int s = sg->s, m = sg->m;
+    int k,q;
+
+    for (k=0;k<m;++k) {
+        const KF_V w = KF_BCAST(st->twiddles+k*s);
+        const kiss_fft_cpx * x0 = x + s*k;
+        kiss_fft_cpx * y0 = y + 2*s*k;
+        for (q=0;q<s;q+=KF_W) {
+            KF_V a0 = KF_LOAD(x0+q);
+            KF_V a1 = KF_LOAD(x0+s*m+q);
+            KF_STORE( y0+q , KF_ADD(a0,a1) );
+            KF_STORE( y0+s+q , KF_CMUL( KF_SUB(a0,a1) , w ) );
+        }
+    }
+}
+
+static KF_TARGET void KF_NAME(stage3)(const kiss_fft_cpx * x,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg)
+{
+    const int s = sg->s, m = sg->m;
+    const float epi3i = st->twiddles[s*m].i;
+    int k,q;
+
+    for (k=0;k<m;++k) {
+        const KF_V w1 = KF_BCAST(st->twiddles+k*s);
+        const KF_V w2 = KF_BCAST(st->twiddles+2*k*s);
+        const kiss_fft_cpx * x0 = x + s*k;
+        kiss_fft_cpx * y0 = y + 3*s*k;
+        for (q=0;q<s;q+=KF_W) {
+            KF_V a0 = KF_LOAD(x0+q);
+            KF_V a1 = KF_LOAD(x0+s*m+q);
+            KF_V a2 = KF_LOAD(x0+2*s*m+q);
+            KF_V s3 = KF_ADD(a1,a2);
+            KF_V s0 = KF_SCALE( KF_SUB(a1,a2) , epi3i );
+            KF_V f1 = KF_SUB( a0 , KF_SCALE(s3,.5f) );
+
+            KF_STORE( y0+q , KF_ADD(a0,s3) );
+            KF_STORE( y0+s+q , KF_CMUL( KF_ADD( f1 , KF_MULPI(s0) ) , w1 ) );
+            KF_STORE( y0+2*s+q , KF_CMUL( KF_ADD( f1 , KF_MULNI(s0) ) , w2 ) );
+        }
+    }
+}
+
+static KF_TARGET void KF_NAME(stage4)(const kiss_fft_cpx * x,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg)
+{
+    const int s = sg->s, m = sg->m;
+    int k,q;
+
+    for (k=0;k<m;++k) {
+        const KF_V w1 = KF_BCAST(st->twiddles+k*s);
+        const KF_V w2 = KF_BCAST(st->twiddles+2*k*s);
+        const KF_V w3 = KF_BCAST(st->twiddles+3*k*s);
+        const kiss_fft_cpx * x0 = x + s*k;
+        kiss_fft_cpx * y0 = y + 4*s*k;
+        for (q=0;q<s;q+=KF_W) {
+            KF_V a0 = KF_LOAD(x0+q);
+            KF_V a1 = KF_LOAD(x0+s*m+q);
+            KF_V a2 = KF_LOAD(x0+2*s*m+q);
+            KF_V a3 = KF_LOAD(x0+3*s*m+q);
+            KF_V b0 = KF_ADD(a0,a2);
+            KF_V b1 = KF_SUB(a0,a2);
+            KF_V b2 = KF_ADD(a1,a3);
+            KF_V b3 = KF_SUB(a1,a3);
+
+            b3 = st->inverse ? KF_MULPI(b3) : KF_MULNI(b3);
+            KF_STORE( y0+q , KF_ADD(b0,b2) );
+            KF_STORE( y0+s+q , KF_CMUL( KF_ADD(b1,b3) , w1 ) );
+            KF_STORE( y0+2*s+q , KF_CMUL( KF_SUB(b0,b2) , w2 ) );
+            KF_STORE( y0+3*s+q , KF_CMUL( KF_SUB(b1,b3) , w3 ) );
+        }
+    }
+}
+
+static KF_TARGET void KF_NAME(stage5)(const kiss_fft_cpx * x,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg)
+{
+    const int s = sg->s, m = sg->m;
+    const kiss_fft_cpx ya = st->twiddles[s*m];
+    const kiss_fft_cpx yb = st->twiddles[2*s*m];
+    int k,q;
+
+    for (k=0;k<m;++k) {
+        const KF_V w1 = KF_BCAST(st->twiddles+k*s);
+        const KF_V w2 = KF_BCAST(st->twiddles+2*k*s);
+        const KF_V w3 = KF_BCAST(st->twiddles+3*k*s);
+        const KF_V w4 = KF_BCAST(st->twiddles+4*k*s);
+        const kiss_fft_cpx * x0 = x + s*k;
+        kiss_fft_cpx * y0 = y + 5*s*k;
+        for (q=0;q<s;q+=KF_W) {
+            KF_V s0 = KF_LOAD(x0+q);
+            KF_V s1 = KF_LOAD(x0+s*m+q);
+            KF_V s2 = KF_LOAD(x0+2*s*m+q);
+            KF_V s3 = KF_LOAD(x0+3*s*m+q);
+            KF_V s4 = KF_LOAD(x0+4*s*m+q);
+            KF_V s7 = KF_ADD(s1,s4);
+            KF_V s10 = KF_SUB(s1,s4);
+            KF_V s8 = KF_ADD(s2,s3);
+            KF_V s9 = KF_SUB(s2,s3);
+            KF_V s5 = KF_ADD( s0 , KF_ADD( KF_SCALE(s7,ya.r) , KF_SCALE(s8,yb.r) ) );
+            KF_V s6 = KF_MULNI( KF_ADD( KF_SCALE(s10,ya.i) , KF_SCALE(s9,yb.i) ) );
+            KF_V s11 = KF_ADD( s0 , KF_ADD( KF_SCALE(s7,yb.r) , KF_SCALE(s8,ya.r) ) );
+            KF_V s12 = KF_MULPI( KF_SUB( KF_SCALE(s10,yb.i) , KF_SCALE(s9,ya.i) ) );
+
+            KF_STORE( y0+q , KF_ADD( s0 , KF_ADD(s7,s8) ) );
+            KF_STORE( y0+s+q , KF_CMUL( KF_SUB(s5,s6) , w1 ) );
+            KF_STORE( y0+2*s+q , KF_CMUL( KF_ADD(s11,s12) , w2 ) );
+            KF_STORE( y0+3*s+q , KF_CMUL( KF_SUB(s11,s12) , w3 ) );
+            KF_STORE( y0+4*s+q , KF_CMUL( KF_ADD(s5,s6) , w4 ) );
+        }
+    }
+}
+
+static KF_TARGET void KF_NAME(stage8)(const kiss_fft_cpx * x,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg)
+{
+    const int s = sg->s, m = sg->m;
+    const KF_V e1 = KF_BCAST(st->twiddles+s*m);
+    const KF_V e3 = KF_BCAST(st->twiddles+3*s*m);
+    KF_V a[8], w[8];
+    int k,q,j;
+
+    for (k=0;k<m;++k) {
+        const kiss_fft_cpx * x0 = x + s*k;
+        kiss_fft_cpx * y0 = y + 8*s*k;
+        for (j=1;j<8;++j)
+            w[j] = KF_BCAST(st->twiddles+j*k*s);
+        for (q=0;q<s;q+=KF_W) {
+            for (j=0;j<8;++j)
+                a[j] = KF_LOAD(x0+j*s*m+q);
+            KF_NAME(dft8)(a,e1,e3,st->inverse);
+            KF_STORE( y0+q , a[0] );
+            for (j=1;j<8;++j)
+                KF_STORE( y0+j*s+q , KF_CMUL(a[j],w[j]) );
+        }
+    }
+}
+
+static const kf_simd_kernels KF_NAME(kernels) = {
+    KF_LEVEL, KF_W, KF_NAME(bfly2), KF_NAME(bfly3), KF_NAME(bfly4), KF_NAME(bfly5), KF_NAME(bfly8),
+    KF_NAME(stage2), KF_NAME(stage3), KF_NAME(stage4), KF_NAME(stage5), KF_NAME(stage8)
+};
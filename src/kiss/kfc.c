@@ -0,0 +1,172 @@
+#include "kfc.h"
+#include "_kiss_fft_guts.h"
+
+/*
+ The cache is a singly linked list that only grows. Readers walk it
+ without the mutex and take a reference with a compare-and-swap that
+ only succeeds on a live plan (refs > 0). A plan is created or freed only
+ while holding the mutex, so a node whose count dropped to zero is
+ never revived behind the back of the thread freeing it. Nodes stay
+ in the list until kfc_cleanup.
+ */
+
+#if defined(_MSC_VER)
+#  include <windows.h>
+static SRWLOCK kfc_mutex = SRWLOCK_INIT;
+#  define KFC_LOCK() AcquireSRWLockExclusive(&kfc_mutex)
+#  define KFC_UNLOCK() ReleaseSRWLockExclusive(&kfc_mutex)
+/* volatile reads have acquire semantics with /volatile:ms, the default on x86 and x64 */
+#  define KFC_LOAD(p) (*(p))
+#  define KFC_CAS(p,o,n) (InterlockedCompareExchange((p),(n),(o)) == (o))
+#  define KFC_INC(p) InterlockedIncrement(p)
+#  define KFC_DEC(p) InterlockedDecrement(p)
+#  define KFC_PUBLISH(p,v) InterlockedExchangePointer((PVOID volatile *)(p),(PVOID)(v))
+#else
+#  include <pthread.h>
+static pthread_mutex_t kfc_mutex = PTHREAD_MUTEX_INITIALIZER;
+#  define KFC_LOCK() pthread_mutex_lock(&kfc_mutex)
+#  define KFC_UNLOCK() pthread_mutex_unlock(&kfc_mutex)
+#  define KFC_LOAD(p) __atomic_load_n((p),__ATOMIC_ACQUIRE)
+#  define KFC_CAS(p,o,n) __atomic_compare_exchange_n((p),&(o),(n),0,__ATOMIC_ACQ_REL,__ATOMIC_ACQUIRE)
+#  define KFC_INC(p) __atomic_add_fetch((p),1,__ATOMIC_ACQ_REL)
+#  define KFC_DEC(p) __atomic_sub_fetch((p),1,__ATOMIC_ACQ_REL)
+#  define KFC_PUBLISH(p,v) __atomic_store_n((p),(v),__ATOMIC_RELEASE)
+#endif
+
+/* part of the key, so plans of builds with different kiss_fft_scalar never mix */
+#ifdef FIXED_POINT
+#  define KFC_SCALAR_TYPE ( (int)sizeof(kiss_fft_scalar)*2 + 1 )
+#else
+#  define KFC_SCALAR_TYPE ( (int)sizeof(kiss_fft_scalar)*2 )
+#endif
+
+typedef struct kfc_node {
+    struct kfc_node * next;
+    int nfft;
+    int inverse;
+    int real;
+    int scalar;
+    volatile long refs;
+    void * volatile plan; /* kiss_fft_cfg or kiss_fftr_cfg, NULL once freed */
+} kfc_node;
+
+static kfc_node * volatile kfc_head = NULL;
+
+static int kfc_match(const kfc_node * node,int nfft,int inverse,int real)
+{
+    return node->nfft == nfft && node->inverse == inverse
+        && node->real == real && node->scalar == KFC_SCALAR_TYPE;
+}
+
+static void * kfc_acquire_plan(int nfft,int inverse,int real)
+{
+    kfc_node * node;
+    void * plan;
+    long refs;
+
+    /* fast path: take another reference to a live plan */
+    for (node = KFC_LOAD(&kfc_head); node; node = node->next) {
+        if (!kfc_match(node,nfft,inverse,real))
+            continue;
+        for (refs = KFC_LOAD(&node->refs); refs > 0; refs = KFC_LOAD(&node->refs)) {
+            if (KFC_CAS(&node->refs,refs,refs+1))
+                return KFC_LOAD(&node->plan);
+        }
+        break;
+    }
+
+    KFC_LOCK();
+    for (node = kfc_head; node && !kfc_match(node,nfft,inverse,real); node = node->next)
+        ;
+    if (node == NULL) {
+        node = (kfc_node*)KF_MALLOC(sizeof(kfc_node));
+        if (node == NULL) {
+            KFC_UNLOCK();
+            return NULL;
+        }
+        node->nfft = nfft;
+        node->inverse = inverse;
+        node->real = real;
+        node->scalar = KFC_SCALAR_TYPE;
+        node->refs = 0;
+        node->plan = NULL;
+        node->next = kfc_head;
+        KFC_PUBLISH(&kfc_head,node);
+    }
+    /* a plan whose last reference is being dropped is not freed yet, so reuse it */
+    plan = node->plan;
+    if (plan == NULL) {
+        if (real)
+            plan = kiss_fftr_alloc(nfft,inverse,NULL,NULL);
+        else
+            plan = kiss_fft_alloc(nfft,inverse,NULL,NULL);
+        KFC_PUBLISH(&node->plan,plan);
+    }
+    if (plan)
+        KFC_INC(&node->refs);
+    KFC_UNLOCK();
+    return plan;
+}
+
+static void kfc_release_plan(void * plan,int real)
+{
+    kfc_node * node;
+
+    if (plan == NULL)
+        return;
+    for (node = KFC_LOAD(&kfc_head); node; node = node->next) {
+        if (node->real == real && KFC_LOAD(&node->plan) == plan)
+            break;
+    }
+    if (node == NULL)
+        return;
+    if (KFC_DEC(&node->refs) == 0) {
+        KFC_LOCK();
+        if (KFC_LOAD(&node->refs) == 0 && node->plan) {
+            kiss_fft_free(node->plan);
+            KFC_PUBLISH(&node->plan,NULL);
+        }
+        KFC_UNLOCK();
+    }
+}
+
+kiss_fft_cfg kfc_acquire(int nfft,int inverse_fft)
+{
+    return (kiss_fft_cfg)kfc_acquire_plan(nfft,inverse_fft,0);
+}
+
+void kfc_release(kiss_fft_cfg cfg)
+{
+    kfc_release_plan(cfg,0);
+}
+
+kiss_fftr_cfg kfc_acquire_real(int nfft,int inverse_fft)
+{
+    /* a real plan serves both directions, so both share one entry */
+    (void)inverse_fft;
+    if (nfft & 1)
+        return NULL;
+    return (kiss_fftr_cfg)kfc_acquire_plan(nfft,0,1);
+}
+
+void kfc_release_real(kiss_fftr_cfg cfg)
+{
+    kfc_release_plan(cfg,1);
+}
+
+void kfc_cleanup(void)
+{
+    kfc_node * node;
+
+    KFC_LOCK();
+    node = kfc_head;
+    kfc_head = NULL;
+    while (node) {
+        kfc_node * next = node->next;
+        if (node->plan)
+            kiss_fft_free(node->plan);
+        kiss_fft_free(node);
+        node = next;
+    }
+    KFC_UNLOCK();
+}
@@ -0,0 +1,49 @@
+#ifndef KFC_H
+#define KFC_H
+#include "kiss_fft.h"
+#include "kiss_fftr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+KFC -- Kiss FFT Cache
+
+Process-wide cache of FFT plans, keyed by size, direction (complex
+plans only), real or complex, and scalar type. The first kfc_acquire of a key allocates the
+plan; later calls return the same cfg and only bump its reference
+count, so objects of the same size share one copy of the twiddles.
+
+Lookups of a cached plan take no lock. Creating or freeing a plan
+takes a process-wide mutex. A plan is freed when its last holder calls
+kfc_release.
+
+Holders of a cached plan that may run concurrently must use
+kiss_fft_scratch, or kiss_fftr_scratch and kiss_fftri_scratch, with
+scratch of their own, since kiss_fft, kiss_fftr and kiss_fftri work in
+buffers inside the plan.
+
+typical usage:
+
+    kiss_fftr_cfg cfg = kfc_acquire_real(512,0);
+    kiss_fftr(cfg,timedata,freqdata);
+    kfc_release_real(cfg);
+*/
+
+kiss_fft_cfg kfc_acquire(int nfft,int inverse_fft);
+void kfc_release(kiss_fft_cfg cfg);
+
+/* nfft must be even; returns NULL otherwise. A real plan serves both
+   directions (see kiss_fftr_alloc), so inverse_fft does not change it. */
+kiss_fftr_cfg kfc_acquire_real(int nfft,int inverse_fft);
+void kfc_release_real(kiss_fftr_cfg cfg);
+
+/* frees every cached plan; no plan may still be held */
+void kfc_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -14,6 +14,21 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 
 
 #include "_kiss_fft_guts.h"
+
+/* the SIMD level is detected once and published for every thread */
+#if defined(_MSC_VER)
+#  include <intrin.h>
+/* volatile reads have acquire semantics with /volatile:ms, the default on x86 and x64 */
+#  define KF_SIMD_LOAD(p) (*(p))
+#  define KF_SIMD_PUBLISH(p,v) _InterlockedExchange((p),(v))
+#else
+#  define KF_SIMD_LOAD(p) __atomic_load_n((p),__ATOMIC_ACQUIRE)
+#  define KF_SIMD_PUBLISH(p,v) __atomic_store_n((p),(v),__ATOMIC_RELEASE)
+#endif
+
+#ifdef KISS_FFT_CHECK_ALLOC
+KF_THREAD_LOCAL int kf_transform_depth = 0;
+#endif
 /* The guts header contains all the multiplication and addition macros that are defined for
  fixed or floating point complex numbers.  It also delares the kf_ internal functions.
  */
@@ -22,12 +37,16 @@ static void kf_bfly2(
         kiss_fft_cpx * Fout,
         const size_t fstride,
         const kiss_fft_cfg st,
-        int m
+        int m,
+        int u0,
+        int u1
         )
 {
     kiss_fft_cpx * Fout2;
-    kiss_fft_cpx * tw1 = st->twiddles;
+    kiss_fft_cpx * tw1 = st->twiddles + u0*fstride;
     kiss_fft_cpx t;
+    int k = u1 - u0;
+    Fout += u0;
     Fout2 = Fout + m;
     do{
         C_FIXDIV(*Fout,2); C_FIXDIV(*Fout2,2);
@@ -38,24 +57,29 @@ static void kf_bfly2(
         C_ADDTO( *Fout ,  t );
         ++Fout2;
         ++Fout;
-    }while (--m);
+    }while (--k);
 }
 
 static void kf_bfly4(
         kiss_fft_cpx * Fout,
         const size_t fstride,
         const kiss_fft_cfg st,
-        const size_t m
+        const size_t m,
+        int u0,
+        int u1
         )
 {
     kiss_fft_cpx *tw1,*tw2,*tw3;
     kiss_fft_cpx scratch[6];
-    size_t k=m;
+    size_t k=u1-u0;
     const size_t m2=2*m;
     const size_t m3=3*m;
 
 
-    tw3 = tw2 = tw1 = st->twiddles;
+    tw1 = st->twiddles + u0*fstride;
+    tw2 = st->twiddles + 2*u0*fstride;
+    tw3 = st->twiddles + 3*u0*fstride;
+    Fout += u0;
 
     do {
         C_FIXDIV(*Fout,4); C_FIXDIV(Fout[m],4); C_FIXDIV(Fout[m2],4); C_FIXDIV(Fout[m3],4);
@@ -93,17 +117,21 @@ static void kf_bfly3(
          kiss_fft_cpx * Fout,
          const size_t fstride,
          const kiss_fft_cfg st,
-         size_t m
+         size_t m,
+         int u0,
+         int u1
          )
 {
-     size_t k=m;
+     size_t k=u1-u0;
      const size_t m2 = 2*m;
      kiss_fft_cpx *tw1,*tw2;
      kiss_fft_cpx scratch[5];
      kiss_fft_cpx epi3;
      epi3 = st->twiddles[fstride*m];
 
-     tw1=tw2=st->twiddles;
+     tw1 = st->twiddles + u0*fstride;
+     tw2 = st->twiddles + 2*u0*fstride;
+     Fout += u0;
 
      do{
          C_FIXDIV(*Fout,3); C_FIXDIV(Fout[m],3); C_FIXDIV(Fout[m2],3);
@@ -137,7 +165,9 @@ static void kf_bfly5(
         kiss_fft_cpx * Fout,
         const size_t fstride,
         const kiss_fft_cfg st,
-        int m
+        int m,
+        int u0,
+        int u1
         )
 {
     kiss_fft_cpx *Fout0,*Fout1,*Fout2,*Fout3,*Fout4;
@@ -149,14 +179,14 @@ static void kf_bfly5(
     ya = twiddles[fstride*m];
     yb = twiddles[fstride*2*m];
 
-    Fout0=Fout;
+    Fout0=Fout+u0;
     Fout1=Fout0+m;
     Fout2=Fout0+2*m;
     Fout3=Fout0+3*m;
     Fout4=Fout0+4*m;
 
     tw=st->twiddles;
-    for ( u=0; u<m; ++u ) {
+    for ( u=u0; u<u1; ++u ) {
         C_FIXDIV( *Fout0,5); C_FIXDIV( *Fout1,5); C_FIXDIV( *Fout2,5); C_FIXDIV( *Fout3,5); C_FIXDIV( *Fout4,5);
         scratch[0] = *Fout0;
 
@@ -194,13 +224,189 @@ static void kf_bfly5(
     }
 }
 
+/* length 4 DFT of x0..x3 into y[0..3]; the rotation by -i (+i when inverse) is exact */
+static KF_INLINE void kf_dft4(kiss_fft_cpx * y,kiss_fft_cpx x0,kiss_fft_cpx x1,kiss_fft_cpx x2,kiss_fft_cpx x3,int inverse)
+{
+    kiss_fft_cpx b0,b1,b2,b3;
+    C_ADD(b0,x0,x2);
+    C_SUB(b1,x0,x2);
+    C_ADD(b2,x1,x3);
+    C_SUB(b3,x1,x3);
+    C_ADD(y[0],b0,b2);
+    C_SUB(y[2],b0,b2);
+    if(inverse) {
+        y[1].r = b1.r - b3.i;
+        y[1].i = b1.i + b3.r;
+        y[3].r = b1.r + b3.i;
+        y[3].i = b1.i - b3.r;
+    }else{
+        y[1].r = b1.r + b3.i;
+        y[1].i = b1.i - b3.r;
+        y[3].r = b1.r - b3.i;
+        y[3].i = b1.i + b3.r;
+    }
+}
+
+/* length 8 DFT of a[0..7] in place, as two length 4 DFTs of the even and
+   odd points; e1 and e3 are w^1 and w^3 of the 8th root of unity */
+static KF_INLINE void kf_dft8(kiss_fft_cpx * a,kiss_fft_cpx e1,kiss_fft_cpx e3,int inverse)
+{
+    kiss_fft_cpx e[4],o[4],t;
+    kf_dft4(e,a[0],a[2],a[4],a[6],inverse);
+    kf_dft4(o,a[1],a[3],a[5],a[7],inverse);
+
+    C_ADD(a[0],e[0],o[0]);
+    C_SUB(a[4],e[0],o[0]);
+    C_MUL(t,o[1],e1);
+    C_ADD(a[1],e[1],t);
+    C_SUB(a[5],e[1],t);
+    if(inverse) {
+        t.r = -o[2].i;
+        t.i = o[2].r;
+    }else{
+        t.r = o[2].i;
+        t.i = -o[2].r;
+    }
+    C_ADD(a[2],e[2],t);
+    C_SUB(a[6],e[2],t);
+    C_MUL(t,o[3],e3);
+    C_ADD(a[3],e[3],t);
+    C_SUB(a[7],e[3],t);
+}
+
+static void kf_bfly8(
+        kiss_fft_cpx * Fout,
+        const size_t fstride,
+        const kiss_fft_cfg st,
+        int m,
+        int u0,
+        int u1
+        )
+{
+    kiss_fft_cpx * twiddles = st->twiddles;
+    const kiss_fft_cpx e1 = twiddles[fstride*m];
+    const kiss_fft_cpx e3 = twiddles[3*fstride*m];
+    kiss_fft_cpx scratch[8],t;
+    int u,j;
+
+    for ( u=u0; u<u1; ++u ) {
+        scratch[0] = Fout[u];
+        C_FIXDIV(scratch[0],8);
+        for (j=1;j<8;++j) {
+            t = Fout[u+j*m];
+            C_FIXDIV(t,8);
+            C_MUL(scratch[j],t,twiddles[j*u*fstride]);
+        }
+        kf_dft8(scratch,e1,e3,st->inverse);
+        for (j=0;j<8;++j)
+            Fout[u+j*m] = scratch[j];
+    }
+}
+
+/*
+ Codelets: straight-line DFTs of length 8, 16, 32 and 64 from x, read
+ with stride xs, to y, written with stride ys, in natural order. They
+ replace the bottom levels of the recursion in kf_work. The twiddles
+ w_n^t are tw[t*ts].
+
+ Lengths 16, 32 and 64 are taken as P*Q: Q length P DFTs of the
+ decimated input, a twiddle w_n^(r*k1) on each result, then P length Q
+ DFTs across them. The fixed point build divides by P and then by Q,
+ as the butterflies of the two stages it replaces would.
+ */
+#define KF_CODELET_MAX 64
+
+/* in place length 4 or 8 DFT */
+static KF_INLINE void kf_dft_small(kiss_fft_cpx * a,int p,kiss_fft_cpx e1,kiss_fft_cpx e3,int inverse)
+{
+    if (p == 4)
+        kf_dft4(a,a[0],a[1],a[2],a[3],inverse);
+    else
+        kf_dft8(a,e1,e3,inverse);
+}
+
+static KF_INLINE void kf_codelet_pq(kiss_fft_cpx * y,size_t ys,const kiss_fft_cpx * x,size_t xs,
+        const int P,const int Q,const kiss_fft_cpx * tw,size_t ts,int inverse)
+{
+    const int n = P*Q;
+    const kiss_fft_cpx e1 = tw[(n/8)*ts];
+    const kiss_fft_cpx e3 = tw[(3*n/8)*ts];
+    kiss_fft_cpx a[KF_CODELET_MAX],t[8];
+    int r,j,k;
+
+    for (r=0;r<Q;++r) {
+        for (j=0;j<P;++j) {
+            t[j] = x[(r + Q*j)*xs];
+            C_FIXDIV(t[j],P);
+        }
+        kf_dft_small(t,P,e1,e3,inverse);
+        a[r*P] = t[0];
+        for (k=1;k<P;++k)
+            C_MUL(a[r*P + k],t[k],tw[r*k*ts]);
+    }
+    for (k=0;k<P;++k) {
+        for (r=0;r<Q;++r) {
+            t[r] = a[r*P + k];
+            C_FIXDIV(t[r],Q);
+        }
+        kf_dft_small(t,Q,e1,e3,inverse);
+        for (r=0;r<Q;++r)
+            y[(k + P*r)*ys] = t[r];
+    }
+}
+
+static void kf_codelet8(kiss_fft_cpx * y,size_t ys,const kiss_fft_cpx * x,size_t xs,const kiss_fft_cpx * tw,size_t ts,int inverse)
+{
+    kiss_fft_cpx a[8];
+    int j;
+    for (j=0;j<8;++j) {
+        a[j] = x[j*xs];
+        C_FIXDIV(a[j],8);
+    }
+    kf_dft8(a,tw[ts],tw[3*ts],inverse);
+    for (j=0;j<8;++j)
+        y[j*ys] = a[j];
+}
+
+static void kf_codelet16(kiss_fft_cpx * y,size_t ys,const kiss_fft_cpx * x,size_t xs,const kiss_fft_cpx * tw,size_t ts,int inverse)
+{
+    kf_codelet_pq(y,ys,x,xs,4,4,tw,ts,inverse);
+}
+
+static void kf_codelet32(kiss_fft_cpx * y,size_t ys,const kiss_fft_cpx * x,size_t xs,const kiss_fft_cpx * tw,size_t ts,int inverse)
+{
+    kf_codelet_pq(y,ys,x,xs,8,4,tw,ts,inverse);
+}
+
+static void kf_codelet64(kiss_fft_cpx * y,size_t ys,const kiss_fft_cpx * x,size_t xs,const kiss_fft_cpx * tw,size_t ts,int inverse)
+{
+    kf_codelet_pq(y,ys,x,xs,8,8,tw,ts,inverse);
+}
+
+typedef void (*kf_codelet_fn)(kiss_fft_cpx * y,size_t ys,const kiss_fft_cpx * x,size_t xs,const kiss_fft_cpx * tw,size_t ts,int inverse);
+
+/* the codelet for a length n DFT, or NULL */
+static kf_codelet_fn kf_find_codelet(int n)
+{
+    switch (n) {
+        case 8: return kf_codelet8;
+        case 16: return kf_codelet16;
+        case 32: return kf_codelet32;
+        case 64: return kf_codelet64;
+        default: return NULL;
+    }
+}
+
 /* perform the butterfly for one stage of a mixed radix FFT */
 static void kf_bfly_generic(
         kiss_fft_cpx * Fout,
         const size_t fstride,
         const kiss_fft_cfg st,
         int m,
-        int p
+        int p,
+        int u0,
+        int u1,
+        kiss_fft_cpx * scratch
         )
 {
     int u,k,q1,q;
@@ -208,9 +414,7 @@ static void kf_bfly_generic(
     kiss_fft_cpx t;
     int Norig = st->nfft;
 
-    kiss_fft_cpx * scratch = (kiss_fft_cpx*)KISS_FFT_TMP_ALLOC(sizeof(kiss_fft_cpx)*p);
-
-    for ( u=0; u<m; ++u ) {
+    for ( u=u0; u<u1; ++u ) {
         k=u;
         for ( q1=0 ; q1<p ; ++q1 ) {
             scratch[q1] = Fout[ k  ];
@@ -231,7 +435,134 @@ static void kf_bfly_generic(
             k += m;
         }
     }
-    KISS_FFT_TMP_FREE(scratch);
+}
+
+/* Bluestein plan for radix p, or NULL if p uses the generic butterfly */
+static const kf_bluestein * kf_find_bluestein(const kiss_fft_cfg st,int p)
+{
+    int i;
+    for (i=0;i<st->nbluestein;++i)
+        if (st->bluestein[i].p == p)
+            return st->bluestein + i;
+    return NULL;
+}
+
+static void kf_work(kiss_fft_cpx * Fout,const kiss_fft_cpx * f,const size_t fstride,int in_stride,
+        int * factors,const kiss_fft_cfg st,kiss_fft_cpx * scratch);
+
+/*
+ Length p DFT of a[0..p-1] in place, by Bluestein's algorithm:
+ with c[k] = w^(k*k/2), X[r] = c[r] * sum_k (x[k]*c[k]) * conj(c[r-k]),
+ which is a circular convolution of length L. The inverse transform of
+ the convolution is taken as conj(FFT(conj(.))), so only the forward
+ plan is needed. a and b must both have room for L points.
+
+ The plan of the convolution is shared by every thread that runs the
+ butterfly, so it is run by kf_work straight between a and b, which
+ belong to the caller, and never through an executor that would use
+ the work buffer of its cfg. L is a power of two, so the plan has no
+ generic radix and needs no butterfly scratch.
+ */
+static void kf_bluestein_dft(const kf_bluestein * bp,kiss_fft_cpx * a,kiss_fft_cpx * b)
+{
+    const int p = bp->p, L = bp->L;
+    kiss_fft_cpx t;
+    int k;
+
+    for (k=0;k<p;++k) {
+        C_MUL(t,a[k],bp->chirp[k]);
+        a[k] = t;
+    }
+    memset(a+p,0,sizeof(kiss_fft_cpx)*(L-p));
+    kf_work(b,a,1,1,bp->fft->factors,bp->fft,NULL);
+    for (k=0;k<L;++k) {
+        C_MUL(t,b[k],bp->filter[k]);
+        b[k].r = t.r;
+        b[k].i = -t.i;
+    }
+    kf_work(a,b,1,1,bp->fft->factors,bp->fft,NULL);
+    for (k=0;k<p;++k) {
+        t.r = a[k].r;
+        t.i = -a[k].i;
+        C_MUL(a[k],t,bp->chirp[k]);
+    }
+}
+
+/* the generic butterfly for a large prime p, O(m * p log p) */
+static void kf_bfly_bluestein(
+        kiss_fft_cpx * Fout,
+        const size_t fstride,
+        const kiss_fft_cfg st,
+        int m,
+        const kf_bluestein * bp,
+        int u0,
+        int u1,
+        kiss_fft_cpx * scratch
+        )
+{
+    const int p = bp->p;
+    const int Norig = st->nfft;
+    kiss_fft_cpx * twiddles = st->twiddles;
+    int u,q;
+
+    for ( u=u0; u<u1; ++u ) {
+        /* input q of butterfly u is rotated by w^(u*q) of the full length */
+        int twidx = 0;
+        scratch[0] = Fout[u];
+        for ( q=1; q<p; ++q ) {
+            twidx += fstride * u;
+            if (twidx>=Norig) twidx-=Norig;
+            C_MUL(scratch[q],Fout[u+q*m],twiddles[twidx]);
+        }
+        kf_bluestein_dft(bp,scratch,scratch+bp->L);
+        for ( q=0; q<p; ++q )
+            Fout[u+q*m] = scratch[q];
+    }
+}
+
+/* recombine p sub-transforms of length m, vectorized where possible;
+   only the butterflies u0 <= u < u1 are run, so that the parallel
+   executor can split one recombination between threads. scratch has the
+   cfg's nscratch points for the generic radices */
+static void kf_bfly_range(
+        kiss_fft_cpx * Fout,
+        const size_t fstride,
+        const kiss_fft_cfg st,
+        int m,
+        int p,
+        int u0,
+        int u1,
+        kiss_fft_cpx * scratch
+        )
+{
+    const kf_simd_kernels * simd = st->simd ? kf_simd_select(st->simd,m) : NULL;
+
+    switch (p) {
+        case 2: if (simd) simd->bfly2(Fout,fstride,st,m,u0,u1); else kf_bfly2(Fout,fstride,st,m,u0,u1); break;
+        case 3: if (simd) simd->bfly3(Fout,fstride,st,m,u0,u1); else kf_bfly3(Fout,fstride,st,m,u0,u1); break;
+        case 4: if (simd) simd->bfly4(Fout,fstride,st,m,u0,u1); else kf_bfly4(Fout,fstride,st,m,u0,u1); break;
+        case 5: if (simd) simd->bfly5(Fout,fstride,st,m,u0,u1); else kf_bfly5(Fout,fstride,st,m,u0,u1); break;
+        case 8: if (simd) simd->bfly8(Fout,fstride,st,m,u0,u1); else kf_bfly8(Fout,fstride,st,m,u0,u1); break;
+        default: {
+            const kf_bluestein * bp = kf_find_bluestein(st,p);
+            if (bp)
+                kf_bfly_bluestein(Fout,fstride,st,m,bp,u0,u1,scratch);
+            else
+                kf_bfly_generic(Fout,fstride,st,m,p,u0,u1,scratch);
+        } break;
+    }
+}
+
+static void kf_bfly(
+        kiss_fft_cpx * Fout,
+        const size_t fstride,
+        const kiss_fft_cfg st,
+        int m,
+        int p,
+        kiss_fft_cpx * scratch
+        )
+{
+    kf_bfly_range(Fout,fstride,st,m,p,0,m,scratch);
 }
 
 static
@@ -241,38 +572,21 @@ void kf_work(
         const size_t fstride,
         int in_stride,
         int * factors,
-        const kiss_fft_cfg st
+        const kiss_fft_cfg st,
+        kiss_fft_cpx * scratch
         )
 {
     kiss_fft_cpx * Fout_beg=Fout;
     const int p=*factors++; /* the radix  */
     const int m=*factors++; /* stage's fft length/p */
     const kiss_fft_cpx * Fout_end = Fout + p*m;
+    const kf_codelet_fn codelet = kf_find_codelet(p*m);
 
-#ifdef _OPENMP
-    // use openmp extensions at the 
-    // top-level (not recursive)
-    if (fstride==1 && p<=5)
-    {
-        int k;
-
-        // execute the p different work units in different threads
-#       pragma omp parallel for
-        for (k=0;k<p;++k) 
-            kf_work( Fout +k*m, f+ fstride*in_stride*k,fstride*p,in_stride,factors,st);
-        // all threads have joined by this point
-
-        switch (p) {
-            case 2: kf_bfly2(Fout,fstride,st,m); break;
-            case 3: kf_bfly3(Fout,fstride,st,m); break; 
-            case 4: kf_bfly4(Fout,fstride,st,m); break;
-            case 5: kf_bfly5(Fout,fstride,st,m); break; 
-            default: kf_bfly_generic(Fout,fstride,st,m,p); break;
-        }
+    if (codelet) {
+        /* the remaining levels in one straight-line DFT */
+        codelet(Fout,1,f,fstride*in_stride,st->twiddles,fstride,st->inverse);
         return;
     }
-#endif
-
     if (m==1) {
         do{
             *Fout = *f;
@@ -284,7 +598,7 @@ void kf_work(
             // DFT of size m*p performed by doing
             // p instances of smaller DFTs of size m, 
             // each one takes a decimated version of the input
-            kf_work( Fout , f, fstride*p, in_stride, factors,st);
+            kf_work( Fout , f, fstride*p, in_stride, factors,st,scratch);
             f += fstride*in_stride;
         }while( (Fout += m) != Fout_end );
     }
@@ -292,12 +606,512 @@ void kf_work(
     Fout=Fout_beg;
 
     // recombine the p smaller DFTs 
-    switch (p) {
-        case 2: kf_bfly2(Fout,fstride,st,m); break;
-        case 3: kf_bfly3(Fout,fstride,st,m); break; 
-        case 4: kf_bfly4(Fout,fstride,st,m); break;
-        case 5: kf_bfly5(Fout,fstride,st,m); break; 
-        default: kf_bfly_generic(Fout,fstride,st,m,p); break;
+    kf_bfly(Fout,fstride,st,m,p,scratch);
+}
+
+/*
+ Parallel executor: the recursion of kf_work, cut at the shallowest
+ level that has enough independent sub-transforms to keep every thread
+ busy. The sub-transforms below the cut run as pool tasks; then each
+ level above it recombines its groups, with the butterflies of every
+ group split into chunks, so the top levels, which have only a few
+ groups, still spread over all threads.
+ */
+typedef struct {
+    kiss_fft_cfg st;
+    const kiss_fft_cpx * fin;
+    kiss_fft_cpx * fout;
+    int in_stride;
+    kiss_fft_cpx * scratch; /* nscratch points per thread */
+    int depth;              /* levels above the cut */
+    int nblocks;            /* sub-transforms below the cut */
+    int blocklen;           /* and their length */
+    /* the level being recombined */
+    int fstride;
+    int p;
+    int m;
+    int chunk;
+    int nchunks;
+} kf_par;
+
+/* butterflies per recombination task; a multiple of every simd width */
+#define KF_PAR_CHUNK 256
+
+static void kf_par_leaf(void * arg,int task,int worker)
+{
+    const kf_par * par = (const kf_par*)arg;
+    const kiss_fft_cfg st = par->st;
+    int span = par->nblocks, rem = task, off = 0, fs = 1, j;
+
+    /* output block 'task' reads the input from the digit reversal of its index */
+    for (j=0;j<par->depth;++j) {
+        const int p = st->factors[2*j];
+        const int k = rem / (span /= p);
+        rem -= k*span;
+        off += k*fs;
+        fs *= p;
+    }
+    kf_work(par->fout + (size_t)task*par->blocklen, par->fin + (size_t)off*par->in_stride,
+            par->nblocks, par->in_stride, st->factors + 2*par->depth, st,
+            par->scratch + (size_t)worker*st->nscratch);
+}
+
+static void kf_par_bfly(void * arg,int task,int worker)
+{
+    const kf_par * par = (const kf_par*)arg;
+    const int group = task / par->nchunks;
+    const int u0 = (task % par->nchunks) * par->chunk;
+    const int u1 = u0 + par->chunk < par->m ? u0 + par->chunk : par->m;
+
+    kf_bfly_range(par->fout + (size_t)group*par->p*par->m, par->fstride, par->st,
+                  par->m, par->p, u0, u1, par->scratch + (size_t)worker*par->st->nscratch);
+}
+
+/* returns 0, leaving the transform to the caller, for plans too small to split */
+static int kf_parallel(const kiss_fft_cfg st,const kiss_fft_cpx * fin,kiss_fft_cpx * fout,int in_stride,kiss_fft_cpx * work)
+{
+    const int nthreads = kf_pool_size();
+    const int target = 4*nthreads;
+    int maxthreads, nlevels, groups, j;
+    kf_par par;
+
+    /* the per-thread butterfly scratch is carved from the second block
+       of work, which the recursive path does not use */
+    maxthreads = st->nscratch ? (st->nfft + st->nscratch) / st->nscratch : nthreads;
+    if (maxthreads > nthreads)
+        maxthreads = nthreads;
+    if (st->nfft < KISS_FFT_PARALLEL_MIN || maxthreads < 2)
+        return 0;
+
+    for (nlevels=1; st->factors[2*nlevels-1] != 1; ++nlevels)
+        ;
+    par.st = st;
+    par.fin = fin;
+    par.fout = fin == fout ? work : fout;
+    par.in_stride = in_stride;
+    par.scratch = work + st->nfft;
+    par.depth = 0;
+    par.nblocks = 1;
+    par.blocklen = st->nfft;
+    while (par.depth < nlevels-1 && par.nblocks < target) {
+        par.nblocks *= st->factors[2*par.depth];
+        par.blocklen = st->factors[2*par.depth+1];
+        ++par.depth;
+    }
+    kf_pool_run(kf_par_leaf,&par,par.nblocks,maxthreads);
+
+    groups = par.nblocks;
+    for (j=par.depth-1;j>=0;--j) {
+        par.p = st->factors[2*j];
+        par.m = st->factors[2*j+1];
+        groups /= par.p;
+        par.fstride = groups;
+        par.nchunks = (target + groups - 1) / groups;
+        par.chunk = (par.m + par.nchunks - 1) / par.nchunks;
+        par.chunk = par.chunk < KF_PAR_CHUNK ? KF_PAR_CHUNK : (par.chunk + 15) & ~15;
+        if (par.chunk >= par.m)
+            par.chunk = par.m;
+        par.nchunks = (par.m + par.chunk - 1) / par.chunk;
+        kf_pool_run(kf_par_bfly,&par,groups*par.nchunks,maxthreads);
+    }
+
+    if (fin == fout)
+        memcpy(fout,work,sizeof(kiss_fft_cpx)*st->nfft);
+    return 1;
+}
+
+/*
+ Stockham autosort stages, used by kf_stockham.
+
+ A stage of radix p reads the p inputs x[q + s*(k + j*m)], j=0..p-1,
+ takes their length p DFT and writes output r, multiplied by the
+ twiddle w^(k*r) of the remaining length p*m, to y[q + s*(p*k + r)].
+ The q loop walks s consecutive values that share one twiddle. Each stage
+ reads one buffer and writes the other, and the result comes out of
+ the last stage in natural order, so no bit reversal or recursion is
+ needed. Only the first stage reads the caller's input, and it reads
+ it with stride xs.
+ */
+static void kf_stage2(const kiss_fft_cpx * x,size_t xs,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg)
+{
+    const int s = sg->s, m = sg->m;
+    int k,q;
+    for (k=0;k<m;++k) {
+        const kiss_fft_cpx w = st->twiddles[k*s];
+        const kiss_fft_cpx * x0 = x + (size_t)s*k*xs;
+        const kiss_fft_cpx * x1 = x0 + (size_t)s*m*xs;
+        kiss_fft_cpx * y0 = y + s*2*k;
+        kiss_fft_cpx * y1 = y0 + s;
+        for (q=0;q<s;++q) {
+            kiss_fft_cpx a0 = x0[q*xs], a1 = x1[q*xs], t;
+            C_FIXDIV(a0,2); C_FIXDIV(a1,2);
+            C_ADD( y0[q] , a0 , a1 );
+            C_SUB( t , a0 , a1 );
+            C_MUL( y1[q] , t , w );
+        }
+    }
+}
+
+static void kf_stage3(const kiss_fft_cpx * x,size_t xs,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg)
+{
+    const int s = sg->s, m = sg->m;
+    const kiss_fft_cpx epi3 = st->twiddles[s*m];
+    int k,q;
+    for (k=0;k<m;++k) {
+        const kiss_fft_cpx w1 = st->twiddles[k*s];
+        const kiss_fft_cpx w2 = st->twiddles[2*k*s];
+        const kiss_fft_cpx * x0 = x + (size_t)s*k*xs;
+        kiss_fft_cpx * y0 = y + s*3*k;
+        for (q=0;q<s;++q) {
+            kiss_fft_cpx scratch[5];
+            kiss_fft_cpx a0 = x0[q*xs], a1 = x0[(q+s*m)*xs], a2 = x0[(q+2*s*m)*xs];
+            C_FIXDIV(a0,3); C_FIXDIV(a1,3); C_FIXDIV(a2,3);
+
+            C_ADD( scratch[3] , a1 , a2 );
+            C_SUB( scratch[0] , a1 , a2 );
+            C_ADD( y0[q] , a0 , scratch[3] );
+
+            scratch[1].r = a0.r - HALF_OF(scratch[3].r);
+            scratch[1].i = a0.i - HALF_OF(scratch[3].i);
+            C_MULBYSCALAR( scratch[0] , epi3.i );
+
+            scratch[2].r = scratch[1].r - scratch[0].i;
+            scratch[2].i = scratch[1].i + scratch[0].r;
+            C_MUL( y0[q+s] , scratch[2] , w1 );
+            scratch[2].r = scratch[1].r + scratch[0].i;
+            scratch[2].i = scratch[1].i - scratch[0].r;
+            C_MUL( y0[q+2*s] , scratch[2] , w2 );
+        }
+    }
+}
+
+static void kf_stage4(const kiss_fft_cpx * x,size_t xs,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg)
+{
+    const int s = sg->s, m = sg->m;
+    int k,q;
+    for (k=0;k<m;++k) {
+        const kiss_fft_cpx w1 = st->twiddles[k*s];
+        const kiss_fft_cpx w2 = st->twiddles[2*k*s];
+        const kiss_fft_cpx w3 = st->twiddles[3*k*s];
+        const kiss_fft_cpx * x0 = x + (size_t)s*k*xs;
+        kiss_fft_cpx * y0 = y + s*4*k;
+        for (q=0;q<s;++q) {
+            kiss_fft_cpx scratch[5];
+            kiss_fft_cpx a0 = x0[q*xs], a1 = x0[(q+s*m)*xs], a2 = x0[(q+2*s*m)*xs], a3 = x0[(q+3*s*m)*xs];
+            C_FIXDIV(a0,4); C_FIXDIV(a1,4); C_FIXDIV(a2,4); C_FIXDIV(a3,4);
+
+            C_ADD( scratch[0] , a0 , a2 );
+            C_SUB( scratch[1] , a0 , a2 );
+            C_ADD( scratch[2] , a1 , a3 );
+            C_SUB( scratch[3] , a1 , a3 );
+
+            C_ADD( y0[q] , scratch[0] , scratch[2] );
+            C_SUB( scratch[4] , scratch[0] , scratch[2] );
+            C_MUL( y0[q+2*s] , scratch[4] , w2 );
+
+            if(st->inverse) {
+                scratch[4].r = scratch[1].r - scratch[3].i;
+                scratch[4].i = scratch[1].i + scratch[3].r;
+                C_MUL( y0[q+s] , scratch[4] , w1 );
+                scratch[4].r = scratch[1].r + scratch[3].i;
+                scratch[4].i = scratch[1].i - scratch[3].r;
+                C_MUL( y0[q+3*s] , scratch[4] , w3 );
+            }else{
+                scratch[4].r = scratch[1].r + scratch[3].i;
+                scratch[4].i = scratch[1].i - scratch[3].r;
+                C_MUL( y0[q+s] , scratch[4] , w1 );
+                scratch[4].r = scratch[1].r - scratch[3].i;
+                scratch[4].i = scratch[1].i + scratch[3].r;
+                C_MUL( y0[q+3*s] , scratch[4] , w3 );
+            }
+        }
+    }
+}
+
+static void kf_stage5(const kiss_fft_cpx * x,size_t xs,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg)
+{
+    const int s = sg->s, m = sg->m;
+    const kiss_fft_cpx ya = st->twiddles[s*m];
+    const kiss_fft_cpx yb = st->twiddles[2*s*m];
+    int k,q;
+    for (k=0;k<m;++k) {
+        const kiss_fft_cpx w1 = st->twiddles[k*s];
+        const kiss_fft_cpx w2 = st->twiddles[2*k*s];
+        const kiss_fft_cpx w3 = st->twiddles[3*k*s];
+        const kiss_fft_cpx w4 = st->twiddles[4*k*s];
+        const kiss_fft_cpx * x0 = x + (size_t)s*k*xs;
+        kiss_fft_cpx * y0 = y + s*5*k;
+        for (q=0;q<s;++q) {
+            kiss_fft_cpx scratch[13];
+            scratch[0] = x0[q*xs];
+            scratch[1] = x0[(q+s*m)*xs];
+            scratch[2] = x0[(q+2*s*m)*xs];
+            scratch[3] = x0[(q+3*s*m)*xs];
+            scratch[4] = x0[(q+4*s*m)*xs];
+            C_FIXDIV(scratch[0],5); C_FIXDIV(scratch[1],5); C_FIXDIV(scratch[2],5); C_FIXDIV(scratch[3],5); C_FIXDIV(scratch[4],5);
+
+            C_ADD( scratch[7],scratch[1],scratch[4]);
+            C_SUB( scratch[10],scratch[1],scratch[4]);
+            C_ADD( scratch[8],scratch[2],scratch[3]);
+            C_SUB( scratch[9],scratch[2],scratch[3]);
+
+            y0[q].r = scratch[0].r + scratch[7].r + scratch[8].r;
+            y0[q].i = scratch[0].i + scratch[7].i + scratch[8].i;
+
+            scratch[5].r = scratch[0].r + S_MUL(scratch[7].r,ya.r) + S_MUL(scratch[8].r,yb.r);
+            scratch[5].i = scratch[0].i + S_MUL(scratch[7].i,ya.r) + S_MUL(scratch[8].i,yb.r);
+
+            scratch[6].r =  S_MUL(scratch[10].i,ya.i) + S_MUL(scratch[9].i,yb.i);
+            scratch[6].i = -S_MUL(scratch[10].r,ya.i) - S_MUL(scratch[9].r,yb.i);
+
+            C_SUB(scratch[1],scratch[5],scratch[6]);
+            C_MUL( y0[q+s] , scratch[1] , w1 );
+            C_ADD(scratch[4],scratch[5],scratch[6]);
+            C_MUL( y0[q+4*s] , scratch[4] , w4 );
+
+            scratch[11].r = scratch[0].r + S_MUL(scratch[7].r,yb.r) + S_MUL(scratch[8].r,ya.r);
+            scratch[11].i = scratch[0].i + S_MUL(scratch[7].i,yb.r) + S_MUL(scratch[8].i,ya.r);
+            scratch[12].r = - S_MUL(scratch[10].i,yb.i) + S_MUL(scratch[9].i,ya.i);
+            scratch[12].i = S_MUL(scratch[10].r,yb.i) - S_MUL(scratch[9].r,ya.i);
+
+            C_ADD(scratch[2],scratch[11],scratch[12]);
+            C_MUL( y0[q+2*s] , scratch[2] , w2 );
+            C_SUB(scratch[3],scratch[11],scratch[12]);
+            C_MUL( y0[q+3*s] , scratch[3] , w3 );
+        }
+    }
+}
+
+static void kf_stage8(const kiss_fft_cpx * x,size_t xs,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg)
+{
+    const int s = sg->s, m = sg->m;
+    const kiss_fft_cpx e1 = st->twiddles[s*m];
+    const kiss_fft_cpx e3 = st->twiddles[3*s*m];
+    int k,q,j;
+    for (k=0;k<m;++k) {
+        const kiss_fft_cpx * x0 = x + (size_t)s*k*xs;
+        kiss_fft_cpx * y0 = y + s*8*k;
+        for (q=0;q<s;++q) {
+            kiss_fft_cpx scratch[8];
+            for (j=0;j<8;++j) {
+                scratch[j] = x0[(q+j*s*m)*xs];
+                C_FIXDIV(scratch[j],8);
+            }
+            kf_dft8(scratch,e1,e3,st->inverse);
+            y0[q] = scratch[0];
+            for (j=1;j<8;++j)
+                C_MUL( y0[q+j*s] , scratch[j] , st->twiddles[j*k*s] );
+        }
+    }
+}
+
+static void kf_stage_generic(const kiss_fft_cpx * x,size_t xs,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg,kiss_fft_cpx * scratch)
+{
+    const int p = sg->p, s = sg->s, m = sg->m;
+    const int Norig = st->nfft;
+    const kf_bluestein * bp = kf_find_bluestein(st,p);
+    kiss_fft_cpx * twiddles = st->twiddles;
+    kiss_fft_cpx t,acc;
+    int k,q,j,r;
+
+    for (k=0;k<m;++k) {
+        for (q=0;q<s;++q) {
+            for (j=0;j<p;++j) {
+                scratch[j] = x[(q + (size_t)s*(k + j*m))*xs];
+                C_FIXDIV(scratch[j],p);
+            }
+            if (bp) {
+                kf_bluestein_dft(bp,scratch,scratch+bp->L);
+                y[q + s*p*k] = scratch[0];
+                for (r=1;r<p;++r)
+                    C_MUL( y[q + s*(p*k + r)] , scratch[r] , twiddles[k*r*s] );
+                continue;
+            }
+            for (r=0;r<p;++r) {
+                /* w_p^(j*r) is twiddles[j*r*s*m mod nfft] */
+                int twidx = 0;
+                acc = scratch[0];
+                for (j=1;j<p;++j) {
+                    twidx += r*s*m;
+                    if (twidx>=Norig) twidx-=Norig;
+                    C_MUL(t,scratch[j],twiddles[twidx]);
+                    C_ADDTO(acc,t);
+                }
+                if (r == 0)
+                    y[q + s*p*k] = acc;
+                else
+                    C_MUL( y[q + s*(p*k + r)] , acc , twiddles[k*r*s] );
+            }
+        }
+    }
+}
+
+/* one Stockham stage, vectorized over q where possible */
+static void kf_run_stage(const kiss_fft_cpx * x,size_t xs,kiss_fft_cpx * y,const kiss_fft_cfg st,const kf_stage * sg,kiss_fft_cpx * scratch)
+{
+    const kf_simd_kernels * simd = st->simd && xs == 1 ? kf_simd_select(st->simd,sg->s) : NULL;
+
+    switch (sg->p) {
+        case 2: if (simd) simd->stage2(x,y,st,sg); else kf_stage2(x,xs,y,st,sg); break;
+        case 3: if (simd) simd->stage3(x,y,st,sg); else kf_stage3(x,xs,y,st,sg); break;
+        case 4: if (simd) simd->stage4(x,y,st,sg); else kf_stage4(x,xs,y,st,sg); break;
+        case 5: if (simd) simd->stage5(x,y,st,sg); else kf_stage5(x,xs,y,st,sg); break;
+        case 8: if (simd) simd->stage8(x,y,st,sg); else kf_stage8(x,xs,y,st,sg); break;
+        default: kf_stage_generic(x,xs,y,st,sg,scratch); break;
+    }
+}
+
+/*
+ Iterative executor: runs the stages planned by kiss_fft_alloc in order,
+ ping-ponging between the first two nfft point blocks of work so that the
+ last stage writes fout. fout is only ever written by the last stage, so
+ fin may equal fout without a temporary copy.
+ */
+static void kf_stockham(const kiss_fft_cfg st,const kiss_fft_cpx * fin,kiss_fft_cpx * fout,int in_stride,kiss_fft_cpx * work)
+{
+    kiss_fft_cpx * bufa = work;
+    kiss_fft_cpx * bufb = work + st->nfft;
+    kiss_fft_cpx * scratch = work + 2*st->nfft;
+    const kiss_fft_cpx * x = fin;
+    size_t xs = in_stride;
+    int i;
+
+    if (st->nstages == 1 && fin == fout) {
+        /* a single stage would read and write the same buffer */
+        for (i=0;i<st->nfft;++i)
+            bufb[i] = fin[i*xs];
+        x = bufb;
+        xs = 1;
+    }
+    for (i=0;i<st->nstages;++i) {
+        kiss_fft_cpx * y = i == st->nstages-1 ? fout : ( (i & 1) ? bufb : bufa );
+        kf_run_stage(x,xs,y,st,st->stages+i,scratch);
+        x = y;
+        xs = 1;
+    }
+}
+
+/*
+ Six-step executor (Bailey) for plans too large for the caches. With
+ nfft = n1*n2, the input is read as n1 rows of n2 points and
+   1. transposed into n2 rows of n1 points,
+   2. every row is transformed by the length n1 plan,
+   3. point k1 of row j2 is multiplied by w^(j2*k1),
+   4. transposed into n1 rows of n2 points,
+   5. every row is transformed by the length n2 plan,
+   6. transposed into fout.
+ Each FFT then runs on one contiguous row that fits in cache, and the
+ strided access is confined to the tiled transposes.
+ */
+#define KF_TILE 32
+
+/* y[c*rows + r] = x[(r*cols + c)*xs], a tile at a time */
+static void kf_transpose(const kiss_fft_cpx * x,size_t xs,kiss_fft_cpx * y,int rows,int cols)
+{
+    int r0,c0,r,c;
+    for (r0=0;r0<rows;r0+=KF_TILE) {
+        const int r1 = r0+KF_TILE < rows ? r0+KF_TILE : rows;
+        for (c0=0;c0<cols;c0+=KF_TILE) {
+            const int c1 = c0+KF_TILE < cols ? c0+KF_TILE : cols;
+            for (r=r0;r<r1;++r)
+                for (c=c0;c<c1;++c)
+                    y[(size_t)c*rows + r] = x[((size_t)r*cols + c)*xs];
+        }
+    }
+}
+
+static void kf_sixstep(const kiss_fft_cfg st,const kiss_fft_cpx * fin,kiss_fft_cpx * fout,int in_stride,kiss_fft_cpx * work)
+{
+    const kiss_fft_cfg plan1 = st->sixstep[0];
+    const kiss_fft_cfg plan2 = st->sixstep[1];
+    const int n1 = plan1->nfft, n2 = plan2->nfft;
+    kiss_fft_cpx * bufa = work;
+    kiss_fft_cpx * bufb = work + st->nfft;
+    kiss_fft_cpx * scratch = work + 2*st->nfft;
+    int j2,k1;
+
+    kf_transpose(fin,in_stride,bufa,n1,n2);
+    for (j2=0;j2<n2;++j2) {
+        kiss_fft_cpx * row = bufb + (size_t)j2*n1;
+        int q = 0, r = 0; /* j2*k1 = q*n2 + r */
+        kf_work(row,bufa + (size_t)j2*n1,1,1,plan1->factors,plan1,scratch);
+        /* w^(j2*k1) = w^(q*n2) * w^r keeps the lookups within n1 + n2
+           entries of the twiddle table */
+        for (k1=1;k1<n1;++k1) {
+            kiss_fft_cpx w,t;
+            r += j2;
+            if (r >= n2) {
+                r -= n2;
+                ++q;
+            }
+            C_MUL(w,st->twiddles[(size_t)q*n2],st->twiddles[r]);
+            C_MUL(t,row[k1],w);
+            row[k1] = t;
+        }
+    }
+    kf_transpose(bufb,1,bufa,n2,n1);
+    for (k1=0;k1<n1;++k1)
+        kf_work(bufb + (size_t)k1*n2,bufa + (size_t)k1*n2,1,1,plan2->factors,plan2,scratch);
+    kf_transpose(bufb,1,fout,n1,n2);
+}
+
+/* n1 of the six-step split of nfft: the product of the leading factors
+   that stays within sqrt(nfft). 0 when nfft is below KISS_FFT_SIXSTEP_MIN
+   or has no useful split. */
+static int kf_sixstep_split(int nfft,const int * factors)
+{
+    int n1 = 1, i;
+    if (nfft < KISS_FFT_SIXSTEP_MIN)
+        return 0;
+    for (i=0;;i+=2) {
+        if ((double)n1*factors[i]*n1*factors[i] <= nfft)
+            n1 *= factors[i];
+        if (factors[i+1] == 1)
+            break;
+    }
+    return n1 >= KF_TILE ? n1 : 0;
+}
+
+/*
+ Twiddle tables. Every angle 2*pi*k/n is the image of an angle 2*pi*b/n
+ near zero under the symmetries of the circle that map multiples of
+ 2*pi/n onto each other: the eight symmetries of the octants when 8
+ divides n, the reflections in both axes when n is even, and only the
+ conjugate when n is odd. So cos and sin are evaluated for b up to n/8,
+ n/4 or n/2, and each result is written to all of its images that fall
+ in the requested range.
+ */
+static void kf_twiddle_put(kiss_fft_cpx * tw,int first,int count,int k,double c,double s,int inverse)
+{
+    if (k < first || k >= first + count)
+        return;
+    tw[k-first].r = KF_TRIG(c);
+    tw[k-first].i = KF_TRIG(inverse ? s : -s);
+}
+
+void kf_twiddles(kiss_fft_cpx * tw,int n,int first,int count,int inverse)
+{
+    const double pi=3.141592653589793238462643383279502884197169399375105820974944;
+    const int nsym = n % 8 == 0 ? 8 : ( n % 2 == 0 ? 4 : 2 );
+    const int q = n / 4, h = n / 2;
+    int b;
+
+    for (b=0;b<=n/nsym;++b) {
+        const double phase = 2*pi*b / n;
+        const double c = cos(phase), s = sin(phase);
+
+        kf_twiddle_put(tw,first,count,b,c,s,inverse);
+        kf_twiddle_put(tw,first,count,n-b,c,-s,inverse);
+        if (nsym >= 4) {
+            kf_twiddle_put(tw,first,count,h-b,-c,s,inverse);
+            kf_twiddle_put(tw,first,count,h+b,-c,-s,inverse);
+        }
+        if (nsym == 8) {
+            kf_twiddle_put(tw,first,count,q-b,s,c,inverse);
+            kf_twiddle_put(tw,first,count,q+b,-s,c,inverse);
+            kf_twiddle_put(tw,first,count,3*q-b,-s,-c,inverse);
+            kf_twiddle_put(tw,first,count,3*q+b,s,-c,inverse);
+        }
     }
 }
 
@@ -305,22 +1119,27 @@ void kf_work(
     where 
     p[i] * m[i] = m[i-1]
     m0 = n                  */
-static 
 void kf_factor(int n,int * facbuf)
 {
-    int p=4;
+    kf_factor_order(n,facbuf,KF_ORDER_RADIX8);
+}
+
+void kf_factor_order(int n,int * facbuf,int order)
+{
+    int p = order == KF_ORDER_RADIX4 ? 4 : 8;
     double floor_sqrt;
     floor_sqrt = floor( sqrt((double)n) );
 
-    /*factor out powers of 4, powers of 2, then any remaining primes */
+    /*factor out powers of 8, powers of 4, powers of 2, then any remaining primes */
     do {
         while (n % p) {
             switch (p) {
+                case 8: p = 4; break;
                 case 4: p = 2; break;
                 case 2: p = 3; break;
                 default: p += 2; break;
             }
-            if (p > floor_sqrt)
+            if (p > floor_sqrt && (p & 1))
                 p = n;          /* no more factors, skip to end */
         }
         n /= p;
@@ -329,57 +1148,259 @@ void kf_factor(int n,int * facbuf)
     } while (n > 1);
 }
 
+/* plans kept inside a cfg, the Bluestein convolutions and the six-step
+   rows, are run by kf_work in buffers of the transform, so they are
+   always built the same way, whatever wisdom says about their size */
+static kiss_fft_cfg kf_alloc_inner(int nfft,int inverse_fft,void * mem,size_t * lenmem)
+{
+    kf_tuning tuning;
+    tuning.order = KF_ORDER_RADIX8;
+    tuning.executor = KISS_FFT_EXEC_RECURSIVE;
+    tuning.simd = kiss_fft_simd_level();
+    return kf_alloc_tuned(nfft,inverse_fft,mem,lenmem,&tuning);
+}
+
+/* smallest power of two that holds a linear convolution of two length p sequences */
+static int kf_bluestein_len(int p)
+{
+    int L = 1;
+    while (L < 2*p-1)
+        L <<= 1;
+    return L;
+}
+
+#ifdef KISS_FFT_HAVE_BLUESTEIN
+
+/*
+ Fills in a Bluestein plan for radix p, with its chirp, filter and length L
+ forward cfg placed in mem; returns the number of bytes it needs. mem may be
+ NULL to only query the size.
+ */
+static size_t kf_bluestein_init(kf_bluestein * bp,int p,int inverse,char * mem)
+{
+    const double pi=3.141592653589793238462643383279502884197169399375105820974944;
+    const int L = kf_bluestein_len(p);
+    size_t subsize = 0;
+    size_t memneeded;
+    int k;
+
+    kf_alloc_inner(L,0,NULL,&subsize);
+    memneeded = sizeof(kiss_fft_cpx)*(p+L) + subsize;
+    if (mem == NULL)
+        return memneeded;
+
+    bp->p = p;
+    bp->L = L;
+    bp->chirp = (kiss_fft_cpx*)mem;
+    bp->filter = bp->chirp + p;
+    bp->fft = kf_alloc_inner(L,0,bp->filter + L,&subsize);
+
+    for (k=0;k<p;++k) {
+        /* k*k/2 turns, reduced mod p so the phase stays accurate for large p */
+        double phase = -pi * (double)(((long long)k*k) % (2*p)) / p;
+        if (inverse)
+            phase *= -1;
+        kf_cexp(bp->chirp+k, phase );
+    }
+
+    memset(bp->filter,0,sizeof(kiss_fft_cpx)*L);
+    for (k=0;k<p;++k) {
+        bp->filter[k].r = bp->chirp[k].r;
+        bp->filter[k].i = -bp->chirp[k].i;
+        if (k)
+            bp->filter[L-k] = bp->filter[k];
+    }
+    /* the plan is not shared yet, so its own work buffer is free */
+    kiss_fft(bp->fft,bp->filter,bp->filter);
+    for (k=0;k<L;++k)
+        C_MULBYSCALAR( bp->filter[k] , (kiss_fft_scalar)(1.0/L) );
+    return memneeded;
+}
+
+/* distinct radices of at least KISS_FFT_BLUESTEIN_MIN that would otherwise
+   use kf_bfly_generic, written to primes */
+static int kf_bluestein_primes(const int * factors,int * primes)
+{
+    int n = 0, i, j;
+    for (i=0;;i+=2) {
+        const int p = factors[i];
+        if (p > 5 && (p & 1) && p >= KISS_FFT_BLUESTEIN_MIN) {
+            for (j=0;j<n && primes[j]!=p;++j)
+                ;
+            if (j == n)
+                primes[n++] = p;
+        }
+        if (factors[i+1] == 1)
+            break;
+    }
+    return n;
+}
+#else
+static size_t kf_bluestein_init(kf_bluestein * bp,int p,int inverse,char * mem)
+{
+    (void)bp; (void)p; (void)inverse; (void)mem;
+    return 0;
+}
+
+static int kf_bluestein_primes(const int * factors,int * primes)
+{
+    (void)factors; (void)primes;
+    return 0;
+}
+#endif
+
+/* points of scratch the largest generic or Bluestein butterfly of the plan needs */
+static int kf_scratch_len(const int * factors,const int * primes,int nprimes)
+{
+    int len = 0, i, j;
+    for (i=0;;i+=2) {
+        const int p = factors[i];
+        int need = 0;
+        if (p != 2 && p != 3 && p != 4 && p != 5 && p != 8) {
+            need = p;
+            for (j=0;j<nprimes;++j)
+                if (primes[j] == p)
+                    need = 2*kf_bluestein_len(p);
+        }
+        if (need > len)
+            len = need;
+        if (factors[i+1] == 1)
+            break;
+    }
+    return len;
+}
+
 /*
  *
  * User-callable function to allocate all necessary storage space for the fft.
  *
- * The return value is a contiguous block of memory, allocated with malloc.  As such,
- * It can be freed with free(), rather than a kiss_fft-specific function.
+ * The return value is a contiguous block of memory, allocated with kiss_fft_malloc.
+ * As such, it can be freed with kiss_fft_free.
  * */
 kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem )
+{
+    kf_tuning tuning;
+    /* sizes the planner has measured get the recorded plan */
+    if (kf_wisdom_lookup(nfft,inverse_fft,&tuning))
+        return kf_alloc_tuned(nfft,inverse_fft,mem,lenmem,&tuning);
+    return kf_alloc_tuned(nfft,inverse_fft,mem,lenmem,NULL);
+}
+
+kiss_fft_cfg kf_alloc_tuned(int nfft,int inverse_fft,void * mem,size_t * lenmem,const kf_tuning * tuning)
 {
     kiss_fft_cfg st=NULL;
+    int factors[2*MAXFACTORS];
+    int primes[MAXFACTORS];
+    int nprimes,nscratch,n1,i;
+    size_t sublen[2] = {0,0};
     size_t memneeded = sizeof(struct kiss_fft_state)
-        + sizeof(kiss_fft_cpx)*(nfft-1); /* twiddle factors*/
+        + sizeof(kiss_fft_cpx)*(nfft-1) /* twiddle factors*/
+        + sizeof(kiss_fft_cpx)*nfft*2; /* stockham work buffers */
+
+    /* large prime radices carry a Bluestein plan each */
+    kf_factor_order(nfft,factors,tuning ? tuning->order : KF_ORDER_RADIX8);
+    nprimes = kf_bluestein_primes(factors,primes);
+    nscratch = kf_scratch_len(factors,primes,nprimes);
+    memneeded += sizeof(kiss_fft_cpx)*nscratch; /* butterfly scratch */
+    memneeded += sizeof(kf_bluestein)*nprimes;
+    for (i=0;i<nprimes;++i)
+        memneeded += kf_bluestein_init(NULL,primes[i],inverse_fft,NULL);
+    /* very large sizes carry the two row plans of the six-step executor;
+       their generic radices are among ours, so nscratch covers them */
+    n1 = kf_sixstep_split(nfft,factors);
+    if (n1) {
+        kf_alloc_inner(n1,inverse_fft,NULL,sublen);
+        kf_alloc_inner(nfft/n1,inverse_fft,NULL,sublen+1);
+        memneeded += sublen[0] + sublen[1];
+    }
 
     if ( lenmem==NULL ) {
-        st = ( kiss_fft_cfg)KISS_FFT_MALLOC( memneeded );
+        st = ( kiss_fft_cfg)KF_MALLOC( memneeded );
     }else{
         if (mem != NULL && *lenmem >= memneeded)
             st = (kiss_fft_cfg)mem;
         *lenmem = memneeded;
     }
     if (st) {
-        int i;
+        char * tail;
         st->nfft=nfft;
         st->inverse = inverse_fft;
+        st->simd = kiss_fft_simd_level();
+
+        kf_twiddles(st->twiddles,nfft,0,nfft,st->inverse);
+
+        memcpy(st->factors,factors,sizeof(factors));
 
-        for (i=0;i<nfft;++i) {
-            const double pi=3.141592653589793238462643383279502884197169399375105820974944;
-            double phase = -2*pi*i / nfft;
-            if (st->inverse)
-                phase *= -1;
-            kf_cexp(st->twiddles+i, phase );
+        /* flatten the factors into the stages of the iterative executor */
+        st->executor = KISS_FFT_EXEC_RECURSIVE;
+        st->work = st->twiddles + nfft;
+        st->nscratch = nscratch;
+        st->nstages = 0;
+        for (i=0;;i+=2) {
+            kf_stage * sg = st->stages + st->nstages++;
+            sg->p = st->factors[i];
+            sg->m = st->factors[i+1];
+            sg->s = st->nstages == 1 ? 1 : sg[-1].s * sg[-1].p;
+            if (sg->m == 1)
+                break;
         }
 
-        kf_factor(nfft,st->factors);
+        st->nbluestein = nprimes;
+        st->bluestein = (kf_bluestein*)(st->work + 2*nfft + nscratch);
+        tail = (char*)(st->bluestein + nprimes);
+        for (i=0;i<nprimes;++i)
+            tail += kf_bluestein_init(st->bluestein+i,primes[i],inverse_fft,tail);
+
+        st->sixstep[0] = st->sixstep[1] = NULL;
+        if (n1) {
+            st->sixstep[0] = kf_alloc_inner(n1,inverse_fft,tail,sublen);
+            st->sixstep[1] = kf_alloc_inner(nfft/n1,inverse_fft,tail + sublen[0],sublen+1);
+            st->executor = KISS_FFT_EXEC_SIXSTEP;
+        }
+        if (tuning) {
+            kiss_fft_set_executor(st,tuning->executor);
+            kiss_fft_set_simd_level(st,tuning->simd);
+        }
     }
     return st;
 }
 
 
-void kiss_fft_stride(kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int in_stride)
+void kf_stride_work(const kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int in_stride,kiss_fft_cpx * work)
 {
-    if (fin == fout) {
+    kiss_fft_cpx * scratch = work + 2*st->nfft;
+
+    KF_TRANSFORM_ENTER();
+    if (st->executor == KISS_FFT_EXEC_STOCKHAM) {
+        kf_stockham(st,fin,fout,in_stride,work);
+    }else if (st->executor == KISS_FFT_EXEC_SIXSTEP) {
+        kf_sixstep(st,fin,fout,in_stride,work);
+    }else if (st->executor == KISS_FFT_EXEC_PARALLEL && kf_parallel(st,fin,fout,in_stride,work)) {
+        /* done; smaller plans fall through to the recursive executor */
+    }else if (fin == fout) {
         //NOTE: this is not really an in-place FFT algorithm.
-        //It just performs an out-of-place FFT into a temp buffer
-        kiss_fft_cpx * tmpbuf = (kiss_fft_cpx*)KISS_FFT_TMP_ALLOC( sizeof(kiss_fft_cpx)*st->nfft);
-        kf_work(tmpbuf,fin,1,in_stride, st->factors,st);
-        memcpy(fout,tmpbuf,sizeof(kiss_fft_cpx)*st->nfft);
-        KISS_FFT_TMP_FREE(tmpbuf);
+        //It just performs an out-of-place FFT into the work buffer
+        kf_work(work,fin,1,in_stride, st->factors,st,scratch);
+        memcpy(fout,work,sizeof(kiss_fft_cpx)*st->nfft);
     }else{
-        kf_work( fout, fin, 1,in_stride, st->factors,st );
+        kf_work( fout, fin, 1,in_stride, st->factors,st,scratch );
     }
+    KF_TRANSFORM_LEAVE();
+}
+
+void kiss_fft_stride(kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int in_stride)
+{
+    kf_stride_work(st,fin,fout,in_stride,st->work);
+}
+
+size_t kiss_fft_scratch_size(kiss_fft_cfg st)
+{
+    return sizeof(kiss_fft_cpx) * (2*st->nfft + st->nscratch);
+}
+
+void kiss_fft_scratch(kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,void * scratch)
+{
+    kf_stride_work(st,fin,fout,1,(kiss_fft_cpx*)scratch);
 }
 
 void kiss_fft(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout)
@@ -388,9 +1409,57 @@ void kiss_fft(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout)
 }
 
 
+int kiss_fft_simd_level(void)
+{
+    /* cpuid is only queried once. Concurrent first calls may each
+       detect, but they publish the same value */
+    static volatile long level = -1;
+    long detected = KF_SIMD_LOAD(&level);
+    if (detected < 0) {
+        detected = kf_simd_detect();
+        KF_SIMD_PUBLISH(&level,detected);
+    }
+    return (int)detected;
+}
+
+void kiss_fft_set_simd_level(kiss_fft_cfg st,int level)
+{
+    int supported = kiss_fft_simd_level();
+    int i;
+    st->simd = level < supported ? level : supported;
+    if (st->simd < KISS_FFT_SIMD_NONE)
+        st->simd = KISS_FFT_SIMD_NONE;
+    for (i=0;i<st->nbluestein;++i)
+        kiss_fft_set_simd_level(st->bluestein[i].fft,level);
+    for (i=0;i<2;++i)
+        if (st->sixstep[i])
+            kiss_fft_set_simd_level(st->sixstep[i],level);
+}
+
+void kiss_fft_set_executor(kiss_fft_cfg st,int executor)
+{
+    int i;
+    if (executor == KISS_FFT_EXEC_STOCKHAM || executor == KISS_FFT_EXEC_PARALLEL
+            || (executor == KISS_FFT_EXEC_SIXSTEP && st->sixstep[0]))
+        st->executor = executor;
+    else
+        st->executor = KISS_FFT_EXEC_RECURSIVE;
+    if (st->executor == KISS_FFT_EXEC_PARALLEL && st->nfft >= KISS_FFT_PARALLEL_MIN)
+        kf_pool_prepare();
+    /* the inner plans are run by kf_work on the caller's buffers; keep
+       them on the recursive executor, as kiss_fft_set_simd_level keeps
+       them on the level of the cfg */
+    for (i=0;i<st->nbluestein;++i)
+        kiss_fft_set_executor(st->bluestein[i].fft,KISS_FFT_EXEC_RECURSIVE);
+    for (i=0;i<2;++i)
+        if (st->sixstep[i])
+            kiss_fft_set_executor(st->sixstep[i],KISS_FFT_EXEC_RECURSIVE);
+}
+
 void kiss_fft_cleanup(void)
 {
-    // nothing needed any more
+    kf_pool_shutdown();
+    kf_wisdom_release();
 }
 
 int kiss_fft_next_fast_size(int n)
@@ -65,8 +65,8 @@ typedef struct kiss_fft_state* kiss_fft_cfg;
  *  The return value from fft_alloc is a cfg buffer used internally
  *  by the fft routine or NULL.
  *
- *  If lenmem is NULL, then kiss_fft_alloc will allocate a cfg buffer using malloc.
- *  The returned value should be free()d when done to avoid memory leaks.
+ *  If lenmem is NULL, then kiss_fft_alloc will allocate a cfg buffer using kiss_fft_malloc.
+ *  The returned value should be released with kiss_fft_free when done to avoid memory leaks.
  *  
  *  The state can be placed in a user supplied buffer 'mem':
  *  If lenmem is not NULL and mem is not NULL and *lenmem is large enough,
@@ -76,6 +76,11 @@ typedef struct kiss_fft_state* kiss_fft_cfg;
  *  If lenmem is not NULL and ( mem is NULL or *lenmem is not large enough),
  *      then the function returns NULL and places the minimum cfg 
  *      buffer size in *lenmem.
+ *
+ *  In the floating point build, prime factors of nfft of KISS_FFT_BLUESTEIN_MIN
+ *  (29) or more are transformed with Bluestein's algorithm, so any size costs
+ *  O(nfft log nfft). The cfg buffer then also holds a power-of-two sub-plan
+ *  for each such prime.
  * */
 
 kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem); 
@@ -97,13 +102,158 @@ void kiss_fft(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout);
  * */
 void kiss_fft_stride(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int fin_stride);
 
-/* If kiss_fft_alloc allocated a buffer, it is one contiguous 
-   buffer and can be simply free()d when no longer needed*/
-#define kiss_fft_free free
+/*
+ Transforms never allocate. kiss_fft and kiss_fft_stride work in buffers
+ inside the cfg (in-place transforms, generic and Bluestein radices, the
+ Stockham executor), so a cfg must not be used by two threads at once.
+
+ kiss_fft_scratch performs the same transform as kiss_fft, but works in
+ the caller's scratch of kiss_fft_scratch_size(cfg) bytes instead, which
+ leaves the cfg read-only: threads sharing a cfg each pass their own
+ scratch.
+ */
+size_t kiss_fft_scratch_size(kiss_fft_cfg cfg);
+void kiss_fft_scratch(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,void * scratch);
+
+/*
+ Runtime selected SIMD butterflies.
+
+ On x86 the float build vectorizes the radix 2, 3, 4, 5 and 8 butterflies
+ across the inner iterations of each stage, using the widest instruction
+ set reported by cpuid (SSE2, AVX2 or AVX-512). Sizes are factored into
+ 8s first, then a 4 or a 2, so power of two sizes run mostly in the
+ radix 8 kernels, unless wisdom (below) found the radix-4 order faster.
+ kiss_fft_alloc records kiss_fft_simd_level() in the cfg;
+ kiss_fft_set_simd_level lowers (or restores) it for one cfg, e.g. to
+ compare against the scalar path.
+
+ The vector kernels perform the same operations as the scalar ones, but
+ the AVX2 and AVX-512 kernels use fused multiply-adds. Outputs agree with
+ the scalar path to within about 1e-6 of the largest output magnitude
+ for sizes up to 2^16.
+ */
+#define KISS_FFT_SIMD_NONE 0
+#define KISS_FFT_SIMD_SSE2 1
+#define KISS_FFT_SIMD_AVX2 2
+#define KISS_FFT_SIMD_AVX512 3
+
+int kiss_fft_simd_level(void);
+void kiss_fft_set_simd_level(kiss_fft_cfg cfg,int level);
+
+/*
+ Executor selection.
+ KISS_FFT_EXEC_RECURSIVE is the classic depth-first kf_work recursion.
+ KISS_FFT_EXEC_STOCKHAM runs the factors planned by kiss_fft_alloc as a
+ flat list of Stockham autosort passes, ping-ponging between two work
+ buffers stored in the cfg (or in the scratch of kiss_fft_scratch). It
+ avoids the recursion and walks memory sequentially, and the passes after
+ the first are vectorized over unit-stride runs that share a twiddle.
+ */
+#define KISS_FFT_EXEC_RECURSIVE 0
+#define KISS_FFT_EXEC_STOCKHAM 1
+
+/*
+ KISS_FFT_EXEC_PARALLEL runs the recursive executor on a persistent pool
+ of worker threads. Both the independent sub-transforms and the
+ recombination butterflies of each level are spread over the threads.
+ Plans shorter than 65536 points (KISS_FFT_PARALLEL_MIN) run
+ single-threaded, since the hand-off costs more than it saves there.
+
+ The threads are started when the executor is set on a cfg of that size,
+ by kiss_fft_set_executor or by wisdom, so a transform only wakes them.
+ kiss_fft_set_threads sets the number of threads taking part, the
+ calling one included; 0, the default, uses one per processor. It
+ restarts the pool and must not be called while a transform is running.
+ kiss_fft_cleanup stops the pool; until it is started again, parallel
+ transforms run on the calling thread.
+ */
+#define KISS_FFT_EXEC_PARALLEL 2
+
+/*
+ KISS_FFT_EXEC_SIXSTEP splits nfft into n1*n2 with n1 near sqrt(nfft)
+ and computes the transform as row FFTs of length n1 and n2 between
+ tiled transposes (Bailey's six-step algorithm), so that no pass strides
+ across the whole array. kiss_fft_alloc selects it for nfft of 2^20
+ (KISS_FFT_SIXSTEP_MIN) and more, and stores the two row plans in the
+ cfg. Setting it on a smaller cfg has no effect.
+
+ The executor applies to the cfg as a whole. The plans a cfg keeps
+ inside it, the Bluestein convolutions of large prime factors and the
+ six-step rows, are always run depth-first in buffers owned by the
+ transform, whichever executor is set, so a cfg stays reentrant under
+ kiss_fft_scratch and the pool threads never share a work buffer.
+ */
+#define KISS_FFT_EXEC_SIXSTEP 3
+
+void kiss_fft_set_executor(kiss_fft_cfg cfg,int executor);
+void kiss_fft_set_threads(int nthreads);
+
+/*
+ Measuring planner.
+
+ kiss_fft_alloc_measured takes the same arguments as kiss_fft_alloc, but
+ first times the candidate plans for nfft on this machine: the radix-8
+ and radix-4 factor orders, every executor that applies to the size,
+ and every SIMD level up to kiss_fft_simd_level(). This takes from a few
+ milliseconds to a few seconds. The fastest plan is remembered as wisdom
+ for the rest of the process. From then on, kiss_fft_alloc builds that
+ plan for the same size and direction, and so do kiss_fftr_alloc and
+ kfc, whose real plans run a complex plan of nfft/2 points.
+
+ kiss_fft_export_wisdom writes the wisdom to a text file, and
+ kiss_fft_import_wisdom merges such a file back in, so a process can
+ start with plans measured by an earlier run. Both return 0 on success
+ and -1 on failure. kiss_fft_forget_wisdom, and kiss_fft_cleanup, drop
+ all wisdom. Looking wisdom up takes no lock, so kiss_fft_alloc into a
+ caller's buffer never waits on another thread, even one importing;
+ the few bytes of forgotten entries are returned by kiss_fft_cleanup.
+
+ typical usage:
+
+     if (kiss_fft_import_wisdom("kissfft.wisdom") != 0) {
+         kiss_fft_free(kiss_fft_alloc_measured(1024,0,NULL,NULL));
+         kiss_fft_export_wisdom("kissfft.wisdom");
+     }
+ */
+kiss_fft_cfg kiss_fft_alloc_measured(int nfft,int inverse_fft,void * mem,size_t * lenmem);
+int kiss_fft_export_wisdom(const char * path);
+int kiss_fft_import_wisdom(const char * path);
+void kiss_fft_forget_wisdom(void);
+
+/*
+ Allocator hooks.
+
+ Every buffer the library allocates comes from kiss_fft_malloc. That
+ includes the cfgs of kiss_fft_alloc, kiss_fftr_alloc and
+ kiss_fftr_batch_alloc called with lenmem NULL, the plans and nodes of
+ kfc, wisdom, and the buffers of the out-of-core transforms.
+ kiss_fft_free releases them. By default the two call KISS_FFT_MALLOC
+ and KISS_FFT_FREE.
+
+ kiss_fft_set_allocator routes both through malloc_fn and free_fn,
+ which receive user along with each call. Use it to place plans in
+ huge pages or in a real-time pool, or to count the memory they take.
+ Passing NULL functions restores the default. Memory must be freed
+ through the allocator that made it, so set the hooks before the
+ first allocation. Otherwise, first free every cfg and call kfc_cleanup
+ and kiss_fft_cleanup. The setting is not synchronized and is shared by
+ the symbol sets of kiss_fft_sets.h.
+
+ cfgs come from one contiguous buffer. Release them with
+ kiss_fft_free, or with free() when no allocator is set and USE_SIMD
+ is not defined.
+ */
+typedef void * (*kiss_fft_malloc_fn)(size_t nbytes,void * user);
+typedef void (*kiss_fft_free_fn)(void * ptr,void * user);
+
+void kiss_fft_set_allocator(kiss_fft_malloc_fn malloc_fn,kiss_fft_free_fn free_fn,void * user);
+void * kiss_fft_malloc(size_t nbytes);
+void kiss_fft_free(void * ptr);
 
 /*
  Cleans up some memory that gets managed internally. Not necessary to call, but it might clean up 
- your compiler output to call this before you exit.
+ your compiler output to call this before you exit. No other thread may
+ plan or transform while it runs.
 */
 void kiss_fft_cleanup(void);
 	
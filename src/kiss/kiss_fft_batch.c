@@ -0,0 +1,407 @@
+/*
+ Batched real FFTs: see kiss_fft_batch.h.
+
+ A group of up to 'lanes' channels is packed (even samples in the real
+ part, odd samples in the imaginary part, as kiss_fftr does) and
+ transposed into structure-of-arrays buffers in one pass, transformed
+ together by the complex FFT in _kiss_fft_batch_body.h, then split into
+ the per-channel half spectra on the way back out.
+ */
+
+#include "kiss_fft_batch.h"
+#include "_kiss_fft_guts.h"
+
+#if !defined(FIXED_POINT) && !defined(USE_SIMD)
+
+typedef struct {
+    int nfft;
+    int inverse;
+    int factors[2*MAXFACTORS];
+    const kiss_fft_cpx * twiddles;
+    float * scratch; /* generic radix, 2*maxp*lanes floats */
+} kfb_plan;
+
+typedef struct {
+    void (*fft)(const kfb_plan * st,const float * fre,const float * fim,float * Fre,float * Fim);
+    void (*split)(const kiss_fft_cpx * super_twiddles,int ncfft,const float * fre,const float * fim,float * Xre,float * Xim);
+    void (*merge)(const kiss_fft_cpx * super_twiddles,int ncfft,const float * Xre,const float * Xim,float * fre,float * fim);
+} kfb_impl;
+
+struct kiss_fftr_batch_state{
+    kfb_plan substate;
+    const kfb_impl * impl;
+    int lanes;
+    kiss_fft_cpx * super_twiddles;
+    /* two lane buffers, re then im, (ncfft+1)*lanes floats each */
+    float * bufa;
+    float * bufb;
+};
+
+#ifdef KISS_FFT_HAVE_X86_SIMD
+
+#include <emmintrin.h>
+
+#if defined(__clang__) || ( defined(__GNUC__) && ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) ) )
+#  define KFB_TARGET_SSE2 __attribute__((target("sse2")))
+#  define KFB_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#  define KFB_TARGET_AVX512 __attribute__((target("avx512f")))
+#  define KFB_HAVE_AVX2 1
+#  if defined(__clang__) || __GNUC__ >= 5
+#    define KFB_HAVE_AVX512 1
+#  endif
+#elif defined(_MSC_VER)
+#  define KFB_TARGET_SSE2
+#  define KFB_TARGET_AVX2
+#  define KFB_TARGET_AVX512
+#  if _MSC_VER >= 1700
+#    define KFB_HAVE_AVX2 1
+#  endif
+#  if _MSC_VER >= 1911
+#    define KFB_HAVE_AVX512 1
+#  endif
+#else
+#  define KFB_TARGET_SSE2
+#endif
+
+#if defined(KFB_HAVE_AVX2) || defined(KFB_HAVE_AVX512)
+#  include <immintrin.h>
+#endif
+
+/* SSE2: four lanes per __m128, every lane count */
+#define KFB_TARGET KFB_TARGET_SSE2
+#define KFB_V __m128
+#define KFB_W 4
+#define KFB_LOAD(p) _mm_loadu_ps(p)
+#define KFB_STORE(p,v) _mm_storeu_ps(p,v)
+#define KFB_SET1(s) _mm_set1_ps(s)
+#define KFB_ADD(a,b) _mm_add_ps(a,b)
+#define KFB_SUB(a,b) _mm_sub_ps(a,b)
+#define KFB_MUL(a,b) _mm_mul_ps(a,b)
+#define KFB_L 4
+#define KFB_NAME(x) kfb4_sse2_##x
+#include "_kiss_fft_batch_body.h"
+#undef KFB_L
+#undef KFB_NAME
+#define KFB_L 8
+#define KFB_NAME(x) kfb8_sse2_##x
+#include "_kiss_fft_batch_body.h"
+#undef KFB_L
+#undef KFB_NAME
+#define KFB_L 16
+#define KFB_NAME(x) kfb16_sse2_##x
+#include "_kiss_fft_batch_body.h"
+#undef KFB_L
+#undef KFB_NAME
+#undef KFB_TARGET
+#undef KFB_V
+#undef KFB_W
+#undef KFB_LOAD
+#undef KFB_STORE
+#undef KFB_SET1
+#undef KFB_ADD
+#undef KFB_SUB
+#undef KFB_MUL
+
+#ifdef KFB_HAVE_AVX2
+/* AVX2: eight lanes per __m256 */
+#define KFB_TARGET KFB_TARGET_AVX2
+#define KFB_V __m256
+#define KFB_W 8
+#define KFB_LOAD(p) _mm256_loadu_ps(p)
+#define KFB_STORE(p,v) _mm256_storeu_ps(p,v)
+#define KFB_SET1(s) _mm256_set1_ps(s)
+#define KFB_ADD(a,b) _mm256_add_ps(a,b)
+#define KFB_SUB(a,b) _mm256_sub_ps(a,b)
+#define KFB_MUL(a,b) _mm256_mul_ps(a,b)
+#define KFB_L 8
+#define KFB_NAME(x) kfb8_avx2_##x
+#include "_kiss_fft_batch_body.h"
+#undef KFB_L
+#undef KFB_NAME
+#define KFB_L 16
+#define KFB_NAME(x) kfb16_avx2_##x
+#include "_kiss_fft_batch_body.h"
+#undef KFB_L
+#undef KFB_NAME
+#undef KFB_TARGET
+#undef KFB_V
+#undef KFB_W
+#undef KFB_LOAD
+#undef KFB_STORE
+#undef KFB_SET1
+#undef KFB_ADD
+#undef KFB_SUB
+#undef KFB_MUL
+#endif /* KFB_HAVE_AVX2 */
+
+#ifdef KFB_HAVE_AVX512
+/* AVX-512: sixteen lanes per __m512 */
+#define KFB_TARGET KFB_TARGET_AVX512
+#define KFB_V __m512
+#define KFB_W 16
+#define KFB_LOAD(p) _mm512_loadu_ps(p)
+#define KFB_STORE(p,v) _mm512_storeu_ps(p,v)
+#define KFB_SET1(s) _mm512_set1_ps(s)
+#define KFB_ADD(a,b) _mm512_add_ps(a,b)
+#define KFB_SUB(a,b) _mm512_sub_ps(a,b)
+#define KFB_MUL(a,b) _mm512_mul_ps(a,b)
+#define KFB_L 16
+#define KFB_NAME(x) kfb16_avx512_##x
+#include "_kiss_fft_batch_body.h"
+#undef KFB_L
+#undef KFB_NAME
+#undef KFB_TARGET
+#undef KFB_V
+#undef KFB_W
+#undef KFB_LOAD
+#undef KFB_STORE
+#undef KFB_SET1
+#undef KFB_ADD
+#undef KFB_SUB
+#undef KFB_MUL
+#endif /* KFB_HAVE_AVX512 */
+
+static const kfb_impl * kfb_select(int lanes,int level)
+{
+    switch (lanes) {
+        case 4: return &kfb4_sse2_impl;
+#ifdef KFB_HAVE_AVX2
+        case 8: return level >= KISS_FFT_SIMD_AVX2 ? &kfb8_avx2_impl : &kfb8_sse2_impl;
+#else
+        case 8: return &kfb8_sse2_impl;
+#endif
+        case 16:
+#ifdef KFB_HAVE_AVX512
+            if (level >= KISS_FFT_SIMD_AVX512)
+                return &kfb16_avx512_impl;
+#endif
+#ifdef KFB_HAVE_AVX2
+            if (level >= KISS_FFT_SIMD_AVX2)
+                return &kfb16_avx2_impl;
+#endif
+            return &kfb16_sse2_impl;
+        default: return NULL;
+    }
+}
+
+#else /* KISS_FFT_HAVE_X86_SIMD */
+
+/* portable: one float per "vector", the compiler is free to widen the lane loops */
+#define KFB_TARGET
+#define KFB_V float
+#define KFB_W 1
+#define KFB_LOAD(p) (*(p))
+#define KFB_STORE(p,v) (*(p) = (v))
+#define KFB_SET1(s) (s)
+#define KFB_ADD(a,b) ((a)+(b))
+#define KFB_SUB(a,b) ((a)-(b))
+#define KFB_MUL(a,b) ((a)*(b))
+#define KFB_L 4
+#define KFB_NAME(x) kfb4_##x
+#include "_kiss_fft_batch_body.h"
+#undef KFB_L
+#undef KFB_NAME
+#define KFB_L 8
+#define KFB_NAME(x) kfb8_##x
+#include "_kiss_fft_batch_body.h"
+#undef KFB_L
+#undef KFB_NAME
+#define KFB_L 16
+#define KFB_NAME(x) kfb16_##x
+#include "_kiss_fft_batch_body.h"
+#undef KFB_L
+#undef KFB_NAME
+
+static const kfb_impl * kfb_select(int lanes,int level)
+{
+    (void)level;
+    switch (lanes) {
+        case 4: return &kfb4_impl;
+        case 8: return &kfb8_impl;
+        case 16: return &kfb16_impl;
+        default: return NULL;
+    }
+}
+
+#endif /* KISS_FFT_HAVE_X86_SIMD */
+
+/* round up so the lane buffers start on a cache line */
+#define KFB_ALIGN(n) ( ((n) + 63) & ~(size_t)63 )
+
+kiss_fftr_batch_cfg kiss_fftr_batch_alloc(int nfft,int inverse_fft,int lanes,void * mem,size_t * lenmem)
+{
+    kiss_fftr_batch_cfg st = NULL;
+    size_t memneeded, twoff, superoff, scratchoff, aoff, boff, buflen;
+    int factors[2*MAXFACTORS];
+    int ncfft, maxp, i, level;
+
+    if (nfft & 1) {
+        fprintf(stderr,"Real FFT optimization must be even.\n");
+        return NULL;
+    }
+    level = kiss_fft_simd_level();
+    if (lanes == 0)
+        lanes = level >= KISS_FFT_SIMD_AVX512 ? 16 : level >= KISS_FFT_SIMD_AVX2 ? 8 : 4;
+    if (kfb_select(lanes,level) == NULL) {
+        fprintf(stderr,"Batch FFT lanes must be 4, 8 or 16.\n");
+        return NULL;
+    }
+    ncfft = nfft >> 1;
+    if (ncfft < 1) {
+        fprintf(stderr,"Batch FFT size must be positive.\n");
+        return NULL;
+    }
+
+    /* the generic butterfly needs 2*p floats per lane of scratch */
+    kf_factor(ncfft,factors);
+    for (maxp=0,i=0;;i+=2) {
+        if (factors[i] > maxp)
+            maxp = factors[i];
+        if (factors[i+1] == 1)
+            break;
+    }
+
+    twoff = KFB_ALIGN( sizeof(struct kiss_fftr_batch_state) );
+    superoff = twoff + sizeof(kiss_fft_cpx) * ncfft;
+    scratchoff = KFB_ALIGN( superoff + sizeof(kiss_fft_cpx) * (ncfft/2 + 1) );
+    buflen = KFB_ALIGN( sizeof(float) * (ncfft+1) * lanes );
+    aoff = KFB_ALIGN( scratchoff + sizeof(float) * 2 * maxp * lanes );
+    boff = aoff + 2 * buflen;
+    memneeded = boff + 2 * buflen + 63;
+
+    if (lenmem == NULL) {
+        st = (kiss_fftr_batch_cfg) KF_MALLOC (memneeded);
+    } else {
+        if (mem != NULL && *lenmem >= memneeded)
+            st = (kiss_fftr_batch_cfg) mem;
+        *lenmem = memneeded;
+    }
+    if (!st)
+        return NULL;
+
+    {
+        /* the lane buffers are aligned relative to the block itself */
+        char * base = (char*)st;
+        size_t skew = (size_t)( (64 - ((size_t)base & 63)) & 63 );
+        st->substate.twiddles = (const kiss_fft_cpx *)(base + twoff);
+        st->super_twiddles = (kiss_fft_cpx *)(base + superoff);
+        st->substate.scratch = (float *)(base + scratchoff + skew);
+        st->bufa = (float *)(base + aoff + skew);
+        st->bufb = (float *)(base + boff + skew);
+    }
+    /* as in kiss_fftr_alloc, both directions run the forward
+       transform; kiss_fftri_batch conjugates around it */
+    (void)inverse_fft;
+    st->substate.nfft = ncfft;
+    st->substate.inverse = 0;
+    st->lanes = lanes;
+    st->impl = kfb_select(lanes,level);
+
+    kf_twiddles( (kiss_fft_cpx*)st->substate.twiddles , ncfft , 0 , ncfft , 0 );
+    if (ncfft % 2 == 0) {
+        kf_twiddles( st->super_twiddles , 2*ncfft , ncfft/2+1 , ncfft/2 , 0 );
+    } else {
+        for (i = 0; i < ncfft/2; ++i) {
+            double phase =
+                -3.14159265358979323846264338327 * ((double) (i+1) / ncfft + .5);
+            kf_cexp (st->super_twiddles+i,phase);
+        }
+    }
+    memcpy(st->substate.factors,factors,sizeof(factors));
+    return st;
+}
+
+int kiss_fftr_batch_lanes(kiss_fftr_batch_cfg st)
+{
+    return st->lanes;
+}
+
+void kiss_fftr_batch(kiss_fftr_batch_cfg st,const kiss_fft_scalar * const * timedata,kiss_fft_cpx * const * freqdata,int nchannels)
+{
+    const int L = st->lanes;
+    const int ncfft = st->substate.nfft;
+    const int half = (ncfft+1)*L;
+    float * are = st->bufa, * aim = st->bufa + half;
+    float * bre = st->bufb, * bim = st->bufb + half;
+    int c0,l,k;
+
+    KF_TRANSFORM_ENTER();
+    for (c0=0;c0<nchannels;c0+=L) {
+        const int n = nchannels - c0 < L ? nchannels - c0 : L;
+
+        /* pack and transpose; unused lanes are zeroed */
+        for (l=0;l<L;++l) {
+            if (l < n) {
+                const kiss_fft_scalar * x = timedata[c0+l];
+                for (k=0;k<ncfft;++k) {
+                    are[k*L+l] = x[2*k];
+                    aim[k*L+l] = x[2*k+1];
+                }
+            } else {
+                for (k=0;k<ncfft;++k)
+                    are[k*L+l] = aim[k*L+l] = 0;
+            }
+        }
+
+        st->impl->fft(&st->substate,are,aim,bre,bim);
+        st->impl->split(st->super_twiddles,ncfft,bre,bim,are,aim);
+
+        for (l=0;l<n;++l) {
+            kiss_fft_cpx * X = freqdata[c0+l];
+            for (k=0;k<=ncfft;++k) {
+                X[k].r = are[k*L+l];
+                X[k].i = aim[k*L+l];
+            }
+        }
+    }
+    KF_TRANSFORM_LEAVE();
+}
+
+void kiss_fftri_batch(kiss_fftr_batch_cfg st,const kiss_fft_cpx * const * freqdata,kiss_fft_scalar * const * timedata,int nchannels)
+{
+    const int L = st->lanes;
+    const int ncfft = st->substate.nfft;
+    const int half = (ncfft+1)*L;
+    float * are = st->bufa, * aim = st->bufa + half;
+    float * bre = st->bufb, * bim = st->bufb + half;
+    int c0,l,k;
+
+    KF_TRANSFORM_ENTER();
+    for (c0=0;c0<nchannels;c0+=L) {
+        const int n = nchannels - c0 < L ? nchannels - c0 : L;
+
+        /* the inverse is conj(FFT(conj(Z))) on the forward plan. Merging
+           the conjugated half spectra with the forward super twiddles
+           gives the conjugate of the packed spectrum, except for the
+           imaginary part of bin 0, which is negated afterwards */
+        for (l=0;l<L;++l) {
+            if (l < n) {
+                const kiss_fft_cpx * X = freqdata[c0+l];
+                for (k=0;k<=ncfft;++k) {
+                    are[k*L+l] = X[k].r;
+                    aim[k*L+l] = -X[k].i;
+                }
+            } else {
+                for (k=0;k<=ncfft;++k)
+                    are[k*L+l] = aim[k*L+l] = 0;
+            }
+        }
+
+        st->impl->merge(st->super_twiddles,ncfft,are,aim,bre,bim);
+        for (l=0;l<L;++l)
+            bim[l] = -bim[l];
+        st->impl->fft(&st->substate,bre,bim,are,aim);
+
+        /* transpose back and unpack, conjugating the result */
+        for (l=0;l<n;++l) {
+            kiss_fft_scalar * x = timedata[c0+l];
+            for (k=0;k<ncfft;++k) {
+                x[2*k] = are[k*L+l];
+                x[2*k+1] = -aim[k*L+l];
+            }
+        }
+    }
+    KF_TRANSFORM_LEAVE();
+}
+
+#endif /* !FIXED_POINT && !USE_SIMD */
@@ -0,0 +1,61 @@
+#ifndef KISS_FFT_BATCH_H
+#define KISS_FFT_BATCH_H
+
+#include "kiss_fft.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ Batched real FFTs over many independent signals of the same length.
+
+ Channels are transposed into structure-of-arrays lanes, so every
+ butterfly of the plan runs on 4, 8 or 16 transforms at once with
+ plain vector arithmetic. Unlike USE_SIMD this does not change
+ kiss_fft_scalar, so it coexists with the normal float API in the
+ same binary. Only available in the float build.
+
+ typical usage:
+
+      kiss_fftr_batch_cfg cfg = kiss_fftr_batch_alloc(512,0,0,NULL,NULL);
+      kiss_fftr_batch(cfg,channels,spectra,nchannels);
+      kiss_fftr_batch_free(cfg);
+ */
+
+typedef struct kiss_fftr_batch_state *kiss_fftr_batch_cfg;
+
+/*
+ * kiss_fftr_batch_alloc
+ *
+ * nfft must be even. lanes is the number of signals transformed per
+ * pass (4, 8 or 16); pass 0 to pick the widest that the SIMD level of
+ * the running cpu handles natively (see kiss_fft_simd_level).
+ *
+ * mem and lenmem behave as for kiss_fft_alloc.
+ *
+ * As with kiss_fftr_alloc, the cfg serves both kiss_fftr_batch and
+ * kiss_fftri_batch, and inverse_fft has no effect.
+ */
+kiss_fftr_batch_cfg kiss_fftr_batch_alloc(int nfft,int inverse_fft,int lanes,void * mem,size_t * lenmem);
+
+/* lanes chosen when the cfg was allocated */
+int kiss_fftr_batch_lanes(kiss_fftr_batch_cfg cfg);
+
+/*
+ input timedata[c] has nfft scalar points for each of the nchannels signals
+ output freqdata[c] has nfft/2+1 complex points
+*/
+void kiss_fftr_batch(kiss_fftr_batch_cfg cfg,const kiss_fft_scalar * const * timedata,kiss_fft_cpx * const * freqdata,int nchannels);
+
+/*
+ input freqdata[c] has nfft/2+1 complex points
+ output timedata[c] has nfft scalar points
+*/
+void kiss_fftri_batch(kiss_fftr_batch_cfg cfg,const kiss_fft_cpx * const * freqdata,kiss_fft_scalar * const * timedata,int nchannels);
+
+#define kiss_fftr_batch_free kiss_fft_free
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,44 @@
+#include "_kiss_fft_guts.h"
+
+/*
+ Allocator hooks.
+
+ Every allocation of the library goes through kiss_fft_malloc and
+ kiss_fft_free, which call the functions installed by
+ kiss_fft_set_allocator, or KISS_FFT_MALLOC and KISS_FFT_FREE when
+ none are. This file is not part of the symbol sets of
+ kiss_fft_sets.h, so one allocator serves all of them.
+ */
+
+static kiss_fft_malloc_fn kf_malloc_fn = NULL;
+static kiss_fft_free_fn kf_free_fn = NULL;
+static void * kf_alloc_user = NULL;
+
+void kiss_fft_set_allocator(kiss_fft_malloc_fn malloc_fn,kiss_fft_free_fn free_fn,void * user)
+{
+    if (malloc_fn == NULL || free_fn == NULL) {
+        malloc_fn = NULL;
+        free_fn = NULL;
+        user = NULL;
+    }
+    kf_malloc_fn = malloc_fn;
+    kf_free_fn = free_fn;
+    kf_alloc_user = user;
+}
+
+void * kiss_fft_malloc(size_t nbytes)
+{
+    if (kf_malloc_fn)
+        return kf_malloc_fn(nbytes,kf_alloc_user);
+    return KISS_FFT_MALLOC(nbytes);
+}
+
+void kiss_fft_free(void * ptr)
+{
+    if (ptr == NULL)
+        return;
+    if (kf_free_fn)
+        kf_free_fn(ptr,kf_alloc_user);
+    else
+        KISS_FFT_FREE(ptr);
+}
@@ -0,0 +1,441 @@
+/* 64 bit file offsets for the mappings on 32 bit posix systems, and
+   ftruncate, which strict C99 builds do not declare otherwise */
+#if !defined(_WIN32)
+#  ifndef _FILE_OFFSET_BITS
+#    define _FILE_OFFSET_BITS 64
+#  endif
+#  ifndef _POSIX_C_SOURCE
+#    define _POSIX_C_SOURCE 200112L
+#  endif
+#endif
+
+#include "kiss_fft_ooc.h"
+#include "_kiss_fft_guts.h"
+
+#if defined(_WIN32)
+#  include <windows.h>
+#else
+#  include <sys/types.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+/*
+ Four-step decomposition used by both passes. With nfft = n1*n2, input
+ point j1 + n1*j2 and output point k2 + n2*k1:
+   pass 1: for every j1, the length n2 FFT over j2 of x[j1 + n1*j2],
+           multiplied by w^(j1*k2), is stored as row j1 of the temporary
+           file (n1 rows of n2 points);
+   pass 2: for every k2, the length n1 FFT over j1 of column k2 of the
+           temporary file is stored at X[k2 + n2*k1].
+ Each pass works on a block of adjacent columns at a time, so that the
+ strided accesses become runs of block length.
+ */
+
+/* bytes mapped at once; consecutive runs are served from one window */
+#define KF_OOC_WINDOW ((size_t)32<<20)
+
+typedef struct {
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+    int writable;
+    long long size;
+} kf_ooc_file;
+
+/* one mapped window of a file */
+typedef struct {
+    kf_ooc_file * f;
+    char * base;
+    long long start;
+    size_t len;
+} kf_ooc_view;
+
+static long long kf_ooc_granularity(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+#else
+    return sysconf(_SC_PAGESIZE);
+#endif
+}
+
+/* the body of kf_ooc_open; on failure f may be partly open */
+static int kf_ooc_try_open(kf_ooc_file * f,const char * path,long long size,int writable)
+{
+    f->writable = writable;
+    f->size = size;
+#if defined(_WIN32)
+    {
+        LARGE_INTEGER len;
+        f->mapping = NULL;
+        f->file = CreateFileA(path,writable ? GENERIC_READ|GENERIC_WRITE : GENERIC_READ,
+                              FILE_SHARE_READ|FILE_SHARE_WRITE,NULL,
+                              writable ? OPEN_ALWAYS : OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+        if (f->file == INVALID_HANDLE_VALUE)
+            return -1;
+        if (writable) {
+            len.QuadPart = size;
+            if (!SetFilePointerEx(f->file,len,NULL,FILE_BEGIN) || !SetEndOfFile(f->file))
+                return -1;
+        }else if (!GetFileSizeEx(f->file,&len) || len.QuadPart < size) {
+            return -1;
+        }
+        f->mapping = CreateFileMappingA(f->file,NULL,writable ? PAGE_READWRITE : PAGE_READONLY,
+                                        (DWORD)(size >> 32),(DWORD)size,NULL);
+        return f->mapping ? 0 : -1;
+    }
+#else
+    f->fd = open(path,writable ? O_RDWR|O_CREAT : O_RDONLY,0644);
+    if (f->fd < 0)
+        return -1;
+    if (writable) {
+        if (ftruncate(f->fd,(off_t)size) != 0)
+            return -1;
+    }else{
+        struct stat sb;
+        if (fstat(f->fd,&sb) != 0 || sb.st_size < size)
+            return -1;
+    }
+    return 0;
+#endif
+}
+
+static void kf_ooc_close(kf_ooc_file * f)
+{
+#if defined(_WIN32)
+    if (f->mapping)
+        CloseHandle(f->mapping);
+    if (f->file != INVALID_HANDLE_VALUE)
+        CloseHandle(f->file);
+    f->mapping = NULL;
+    f->file = INVALID_HANDLE_VALUE;
+#else
+    if (f->fd >= 0)
+        close(f->fd);
+    f->fd = -1;
+#endif
+}
+
+/* opens path, which must hold at least size bytes; a writable file is
+   created if needed and set to exactly size bytes */
+static int kf_ooc_open(kf_ooc_file * f,const char * path,long long size,int writable)
+{
+    if (kf_ooc_try_open(f,path,size,writable) == 0)
+        return 0;
+    kf_ooc_close(f);
+    return -1;
+}
+
+static void kf_ooc_unmap(kf_ooc_view * v)
+{
+    if (v->base) {
+#if defined(_WIN32)
+        UnmapViewOfFile(v->base);
+#else
+        munmap(v->base,v->len);
+#endif
+    }
+    v->base = NULL;
+}
+
+/* pointer to len bytes at offset of the file, mapping a new window when
+   they fall outside the current one; NULL if the mapping fails */
+static kiss_fft_cpx * kf_ooc_at(kf_ooc_view * v,long long offset,size_t len)
+{
+    if (v->base == NULL || offset < v->start || offset + (long long)len > v->start + (long long)v->len) {
+        const long long start = offset - offset % kf_ooc_granularity();
+        size_t maplen = KF_OOC_WINDOW;
+
+        kf_ooc_unmap(v);
+        if (maplen < (size_t)(offset - start) + len)
+            maplen = (size_t)(offset - start) + len;
+        if (start + (long long)maplen > v->f->size)
+            maplen = (size_t)(v->f->size - start);
+#if defined(_WIN32)
+        v->base = (char*)MapViewOfFile(v->f->mapping,v->f->writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+                                       (DWORD)(start >> 32),(DWORD)start,maplen);
+#else
+        v->base = (char*)mmap(NULL,maplen,v->f->writable ? PROT_READ|PROT_WRITE : PROT_READ,
+                              MAP_SHARED,v->f->fd,(off_t)start);
+        if (v->base == (char*)MAP_FAILED)
+            v->base = NULL;
+#endif
+        if (v->base == NULL)
+            return NULL;
+        v->start = start;
+        v->len = maplen;
+    }
+    return (kiss_fft_cpx*)(v->base + (offset - v->start));
+}
+
+static void kf_ooc_view_init(kf_ooc_view * v,kf_ooc_file * f)
+{
+    v->f = f;
+    v->base = NULL;
+    v->start = 0;
+    v->len = 0;
+}
+
+/* the largest divisor of nfft up to sqrt(nfft) */
+static long long kf_ooc_split(long long nfft)
+{
+    long long n1 = (long long)sqrt((double)nfft);
+    while (n1 > 1 && nfft % n1)
+        --n1;
+    return n1;
+}
+
+#define KF_OOC_CPX(n) ( (long long)(n) * (long long)sizeof(kiss_fft_cpx) )
+
+/* the two passes from in to out, through tmp */
+static int kf_ooc_run(kf_ooc_file * in,kf_ooc_file * tmp,kf_ooc_file * out,
+                      long long nfft,int inverse_fft,size_t memlimit)
+{
+    const double pi=3.141592653589793238462643383279502884197169399375105820974944;
+    const long long n1 = kf_ooc_split(nfft);
+    const long long n2 = nfft / n1;
+    const long long nmax = n1 > n2 ? n1 : n2;
+    long long b1 = (long long)(memlimit / sizeof(kiss_fft_cpx)) / n2;
+    long long b2 = (long long)(memlimit / sizeof(kiss_fft_cpx)) / n1;
+    kiss_fft_cfg plan1 = NULL, plan2 = NULL;
+    kiss_fft_cpx * buf = NULL, * wlo = NULL, * whi = NULL;
+    kf_ooc_view vin,vtmp,vout;
+    long long c0,j,k,b;
+    int ret = -1;
+
+    if (n2 > 0x7fffffff || KF_OOC_CPX(nmax) > (long long)memlimit) {
+        fprintf(stderr,"kiss_fft_ooc: no factorization of nfft fits in memlimit\n");
+        return -1;
+    }
+    if (b1 > n1)
+        b1 = n1;
+    if (b2 > n2)
+        b2 = n2;
+
+    kf_ooc_view_init(&vin,in);
+    kf_ooc_view_init(&vtmp,tmp);
+    kf_ooc_view_init(&vout,out);
+    plan1 = kiss_fft_alloc((int)n1,inverse_fft,NULL,NULL);
+    plan2 = kiss_fft_alloc((int)n2,inverse_fft,NULL,NULL);
+    buf = (kiss_fft_cpx*)KF_MALLOC( (size_t)KF_OOC_CPX(b1*n2 > b2*n1 ? b1*n2 : b2*n1) );
+    /* w^a = whi[a/n2] * wlo[a%n2] */
+    wlo = (kiss_fft_cpx*)KF_MALLOC( (size_t)KF_OOC_CPX(n2) );
+    whi = (kiss_fft_cpx*)KF_MALLOC( (size_t)KF_OOC_CPX(n1) );
+    if (!plan1 || !plan2 || !buf || !wlo || !whi)
+        goto done;
+    for (k=0;k<n2;++k) {
+        double phase = -2*pi*(double)k / (double)nfft;
+        if (inverse_fft)
+            phase *= -1;
+        kf_cexp(wlo+k,phase);
+    }
+    kf_twiddles(whi,(int)n1,0,(int)n1,inverse_fft);
+
+    /* pass 1: length n2 transforms of b1 input columns at a time */
+    for (c0=0;c0<n1;c0+=b1) {
+        const long long nb = c0+b1 < n1 ? b1 : n1-c0;
+        kiss_fft_cpx * dst;
+        for (j=0;j<n2;++j) {
+            const kiss_fft_cpx * src = kf_ooc_at(&vin,KF_OOC_CPX(j*n1 + c0),(size_t)KF_OOC_CPX(nb));
+            if (!src)
+                goto done;
+            for (b=0;b<nb;++b)
+                buf[b*n2 + j] = src[b];
+        }
+        for (b=0;b<nb;++b) {
+            kiss_fft_cpx * row = buf + b*n2;
+            long long a = 0; /* (c0+b)*k mod nfft */
+            kiss_fft(plan2,row,row);
+            for (k=1;k<n2;++k) {
+                kiss_fft_cpx w,t;
+                a += c0+b;
+                if (a >= nfft)
+                    a -= nfft;
+                C_MUL(w,whi[a/n2],wlo[a%n2]);
+                C_MUL(t,row[k],w);
+                row[k] = t;
+            }
+        }
+        dst = kf_ooc_at(&vtmp,KF_OOC_CPX(c0*n2),(size_t)KF_OOC_CPX(nb*n2));
+        if (!dst)
+            goto done;
+        memcpy(dst,buf,(size_t)KF_OOC_CPX(nb*n2));
+    }
+    kf_ooc_unmap(&vtmp);
+
+    /* pass 2: length n1 transforms of b2 columns of the temporary file at a time */
+    for (c0=0;c0<n2;c0+=b2) {
+        const long long nb = c0+b2 < n2 ? b2 : n2-c0;
+        for (j=0;j<n1;++j) {
+            const kiss_fft_cpx * src = kf_ooc_at(&vtmp,KF_OOC_CPX(j*n2 + c0),(size_t)KF_OOC_CPX(nb));
+            if (!src)
+                goto done;
+            for (b=0;b<nb;++b)
+                buf[b*n1 + j] = src[b];
+        }
+        for (b=0;b<nb;++b)
+            kiss_fft(plan1,buf + b*n1,buf + b*n1);
+        for (k=0;k<n1;++k) {
+            kiss_fft_cpx * dst = kf_ooc_at(&vout,KF_OOC_CPX(k*n2 + c0),(size_t)KF_OOC_CPX(nb));
+            if (!dst)
+                goto done;
+            for (b=0;b<nb;++b)
+                dst[b] = buf[b*n1 + k];
+        }
+    }
+    ret = 0;
+
+done:
+    if (ret)
+        fprintf(stderr,"kiss_fft_ooc: out of memory or address space\n");
+    kf_ooc_unmap(&vin);
+    kf_ooc_unmap(&vtmp);
+    kf_ooc_unmap(&vout);
+    kiss_fft_free(plan1);
+    kiss_fft_free(plan2);
+    kiss_fft_free(buf);
+    kiss_fft_free(wlo);
+    kiss_fft_free(whi);
+    return ret;
+}
+
+/* the kiss_fftr post-processing of the ncfft point transform in out, in place */
+static int kf_ooc_split_real(kf_ooc_file * out,long long ncfft)
+{
+    const double pi=3.141592653589793238462643383279502884197169399375105820974944;
+    const long long block = (long long)(KF_OOC_WINDOW / 2 / sizeof(kiss_fft_cpx));
+    kf_ooc_view vfront,vback;
+    kiss_fft_cpx * front, * back;
+    kiss_fft_cpx fpnk,fpk,f1k,f2k,tw,stw,tdc;
+    long long k0,k,b;
+    int ret = -1;
+
+    kf_ooc_view_init(&vfront,out);
+    kf_ooc_view_init(&vback,out);
+    front = kf_ooc_at(&vfront,0,sizeof(kiss_fft_cpx));
+    back = kf_ooc_at(&vback,KF_OOC_CPX(ncfft),sizeof(kiss_fft_cpx));
+    if (!front || !back)
+        goto done;
+    tdc = front[0];
+    C_FIXDIV(tdc,2);
+    CHECK_OVERFLOW_OP(tdc.r ,+, tdc.i);
+    CHECK_OVERFLOW_OP(tdc.r ,-, tdc.i);
+    front[0].r = tdc.r + tdc.i;
+    back[0].r = tdc.r - tdc.i;
+#ifdef USE_SIMD
+    back[0].i = front[0].i = _mm_set1_ps(0);
+#else
+    back[0].i = front[0].i = 0;
+#endif
+
+    /* pairs k and ncfft-k, a block from each end at a time */
+    for (k0=1;k0<=ncfft/2;k0+=block) {
+        const long long nb = k0+block <= ncfft/2+1 ? block : ncfft/2+1-k0;
+        front = kf_ooc_at(&vfront,KF_OOC_CPX(k0),(size_t)KF_OOC_CPX(nb));
+        back = kf_ooc_at(&vback,KF_OOC_CPX(ncfft-k0-nb+1),(size_t)KF_OOC_CPX(nb));
+        if (!front || !back)
+            goto done;
+        for (b=0;b<nb;++b) {
+            kiss_fft_cpx * pk = front + b;
+            kiss_fft_cpx * pnk = back + nb-1-b;
+            k = k0 + b;
+            kf_cexp(&stw,-pi*((double)k/(double)ncfft + .5));
+            fpk = *pk;
+            fpnk.r =   pnk->r;
+            fpnk.i = - pnk->i;
+            C_FIXDIV(fpk,2);
+            C_FIXDIV(fpnk,2);
+
+            C_ADD( f1k, fpk , fpnk );
+            C_SUB( f2k, fpk , fpnk );
+            C_MUL( tw , f2k , stw );
+
+            pk->r = HALF_OF(f1k.r + tw.r);
+            pk->i = HALF_OF(f1k.i + tw.i);
+            pnk->r = HALF_OF(f1k.r - tw.r);
+            pnk->i = HALF_OF(tw.i - f1k.i);
+        }
+    }
+    ret = 0;
+
+done:
+    if (ret)
+        fprintf(stderr,"kiss_fft_ooc: out of address space\n");
+    kf_ooc_unmap(&vfront);
+    kf_ooc_unmap(&vback);
+    return ret;
+}
+
+/* tmppath, or outpath with ".tmp" appended */
+static char * kf_ooc_tmppath(const char * outpath,const char * tmppath)
+{
+    const char * base = tmppath ? tmppath : outpath;
+    char * path = (char*)KF_MALLOC(strlen(base) + 5);
+    if (path) {
+        strcpy(path,base);
+        if (!tmppath)
+            strcat(path,".tmp");
+    }
+    return path;
+}
+
+static int kf_ooc(const char * inpath,const char * outpath,const char * tmppath,
+                  long long ncfft,int inverse_fft,size_t memlimit,int real)
+{
+    kf_ooc_file in,tmp,out;
+    char * tmpname;
+    int ret = -1;
+
+    if (ncfft < 1) {
+        fprintf(stderr,"kiss_fft_ooc: nfft must be positive\n");
+        return -1;
+    }
+    tmpname = kf_ooc_tmppath(outpath,tmppath);
+    if (tmpname == NULL)
+        return -1;
+    if (kf_ooc_open(&in,inpath,KF_OOC_CPX(ncfft),0) != 0) {
+        fprintf(stderr,"kiss_fft_ooc: cannot open %s\n",inpath);
+    }else{
+        if (kf_ooc_open(&tmp,tmpname,KF_OOC_CPX(ncfft),1) != 0) {
+            fprintf(stderr,"kiss_fft_ooc: cannot create %s\n",tmpname);
+        }else{
+            if (kf_ooc_open(&out,outpath,KF_OOC_CPX(ncfft + real),1) != 0) {
+                fprintf(stderr,"kiss_fft_ooc: cannot create %s\n",outpath);
+            }else{
+                ret = kf_ooc_run(&in,&tmp,&out,ncfft,inverse_fft,memlimit);
+                if (ret == 0 && real)
+                    ret = kf_ooc_split_real(&out,ncfft);
+                kf_ooc_close(&out);
+            }
+            kf_ooc_close(&tmp);
+        }
+        remove(tmpname);
+        kf_ooc_close(&in);
+    }
+    kiss_fft_free(tmpname);
+    return ret;
+}
+
+int kiss_fft_ooc(const char * inpath,const char * outpath,const char * tmppath,
+                 long long nfft,int inverse_fft,size_t memlimit)
+{
+    return kf_ooc(inpath,outpath,tmppath,nfft,inverse_fft,memlimit,0);
+}
+
+int kiss_fftr_ooc(const char * inpath,const char * outpath,const char * tmppath,
+                  long long nfft,size_t memlimit)
+{
+    if (nfft & 1) {
+        fprintf(stderr,"Real FFT optimization must be even.\n");
+        return -1;
+    }
+    return kf_ooc(inpath,outpath,tmppath,nfft/2,0,memlimit,1);
+}
@@ -0,0 +1,47 @@
+#ifndef KISS_FFT_OOC_H
+#define KISS_FFT_OOC_H
+
+#include "kiss_fft.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ Out-of-core FFTs of signals stored in files, for transforms too large
+ to hold in memory.
+
+ The files hold raw kiss_fft_cpx (or kiss_fft_scalar) values in native
+ byte order. They are accessed through memory-mapped windows in two
+ blocked passes of the four-step algorithm: with nfft = n1*n2, the first
+ pass transforms blocks of columns of length n2 into a temporary file,
+ the second transforms blocks of columns of length n1 into the output.
+ Every file access is a run of consecutive points, and the memory held
+ by the library is bounded by memlimit plus a few mapped windows.
+
+ nfft must have a divisor n1 with max(n1,nfft/n1) complex points fitting
+ in memlimit bytes; a divisor near sqrt(nfft) keeps the runs long, so
+ sizes built from small factors (see kiss_fft_next_fast_size) work best.
+
+ tmppath names the temporary file, which is deleted on return; NULL
+ uses outpath with ".tmp" appended. Both functions return 0 on success
+ and -1 on failure, after printing the reason to stderr.
+
+ typical usage:
+
+      kiss_fftr_ooc("recording.f32","spectrum.cpx",NULL,nsamples,256<<20);
+ */
+
+/* inpath holds nfft complex points; writes nfft complex points to outpath */
+int kiss_fft_ooc(const char * inpath,const char * outpath,const char * tmppath,
+                 long long nfft,int inverse_fft,size_t memlimit);
+
+/* inpath holds nfft real points, nfft even; writes the nfft/2+1 complex
+   points of the forward transform to outpath, as kiss_fftr */
+int kiss_fftr_ooc(const char * inpath,const char * outpath,const char * tmppath,
+                  long long nfft,size_t memlimit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
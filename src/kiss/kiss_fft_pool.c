@@ -0,0 +1,256 @@
+#include "_kiss_fft_guts.h"
+
+/*
+ Persistent worker pool for the parallel executor.
+
+ The workers are started at plan time by kf_pool_prepare and then sleep
+ on a condition variable between jobs, so a transform costs a wake-up
+ rather than a thread create/join, and never allocates a stack. A
+ kf_pool_run that finds no workers, before kf_pool_prepare or after
+ kf_pool_shutdown, runs all of its tasks on the calling thread. A job is a range of independent tasks;
+ every thread, the caller included, takes the next unclaimed task with
+ an atomic increment until none is left, so a thread that finishes
+ early takes over work another thread has not reached yet.
+
+ One job runs at a time. A kf_pool_run that finds the pool busy, for
+ instance from a second thread transforming at the same moment, runs
+ all of its tasks on the calling thread instead of waiting.
+ */
+
+#define KF_POOL_MAX_THREADS 64
+
+#if defined(_MSC_VER)
+#  include <windows.h>
+typedef HANDLE kf_thread;
+static SRWLOCK kf_pool_mutex = SRWLOCK_INIT;
+static SRWLOCK kf_pool_busy = SRWLOCK_INIT;
+static CONDITION_VARIABLE kf_pool_wake = CONDITION_VARIABLE_INIT;
+static CONDITION_VARIABLE kf_pool_done = CONDITION_VARIABLE_INIT;
+#  define KF_POOL_LOCK() AcquireSRWLockExclusive(&kf_pool_mutex)
+#  define KF_POOL_UNLOCK() ReleaseSRWLockExclusive(&kf_pool_mutex)
+#  define KF_POOL_WAIT(cv) SleepConditionVariableSRW(&(cv),&kf_pool_mutex,INFINITE,0)
+#  define KF_POOL_SIGNAL(cv) WakeConditionVariable(&(cv))
+#  define KF_POOL_BROADCAST(cv) WakeAllConditionVariable(&(cv))
+#  define KF_POOL_BEGIN_BUSY() AcquireSRWLockExclusive(&kf_pool_busy)
+#  define KF_POOL_TRY_BUSY() TryAcquireSRWLockExclusive(&kf_pool_busy)
+#  define KF_POOL_END_BUSY() ReleaseSRWLockExclusive(&kf_pool_busy)
+/* returns the value before the increment */
+#  define KF_POOL_NEXT(p) (InterlockedIncrement(p) - 1)
+#  define KF_POOL_RESET(p) InterlockedExchange((p),0)
+#else
+#  include <pthread.h>
+#  include <stdint.h>
+#  include <unistd.h>
+typedef pthread_t kf_thread;
+static pthread_mutex_t kf_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t kf_pool_busy = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t kf_pool_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t kf_pool_done = PTHREAD_COND_INITIALIZER;
+#  define KF_POOL_LOCK() pthread_mutex_lock(&kf_pool_mutex)
+#  define KF_POOL_UNLOCK() pthread_mutex_unlock(&kf_pool_mutex)
+#  define KF_POOL_WAIT(cv) pthread_cond_wait(&(cv),&kf_pool_mutex)
+#  define KF_POOL_SIGNAL(cv) pthread_cond_signal(&(cv))
+#  define KF_POOL_BROADCAST(cv) pthread_cond_broadcast(&(cv))
+#  define KF_POOL_BEGIN_BUSY() pthread_mutex_lock(&kf_pool_busy)
+#  define KF_POOL_TRY_BUSY() (pthread_mutex_trylock(&kf_pool_busy) == 0)
+#  define KF_POOL_END_BUSY() pthread_mutex_unlock(&kf_pool_busy)
+#  define KF_POOL_NEXT(p) __atomic_fetch_add((p),1,__ATOMIC_ACQ_REL)
+#  define KF_POOL_RESET(p) __atomic_store_n((p),0,__ATOMIC_RELEASE)
+#endif
+
+static struct {
+    int nthreads;        /* threads running tasks, the caller included; 0 until started */
+    int requested;       /* kiss_fft_set_threads, 0 for one per processor */
+    kf_thread threads[KF_POOL_MAX_THREADS];
+    int stop;
+    unsigned generation; /* bumped for every job */
+    unsigned started;    /* generation when the workers were started */
+    int pending;         /* workers that have not finished the current job */
+    kf_pool_fn fn;
+    void * arg;
+    int ntasks;
+    int maxthreads;
+    volatile long next;  /* next unclaimed task */
+} kf_pool;
+
+static int kf_pool_processors(void)
+{
+#if defined(_MSC_VER)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+/* claims and runs tasks of the current job until none is left */
+static void kf_pool_work(kf_pool_fn fn,void * arg,int ntasks,int maxthreads,int worker)
+{
+    long task;
+    if (worker >= maxthreads)
+        return;
+    while ((task = KF_POOL_NEXT(&kf_pool.next)) < ntasks)
+        fn(arg,(int)task,worker);
+}
+
+static void kf_pool_worker(int worker)
+{
+    unsigned seen;
+
+    KF_POOL_LOCK();
+    /* not the current generation: a job may already be waiting for this worker */
+    seen = kf_pool.started;
+    for (;;) {
+        kf_pool_fn fn;
+        void * arg;
+        int ntasks,maxthreads;
+
+        while (!kf_pool.stop && kf_pool.generation == seen)
+            KF_POOL_WAIT(kf_pool_wake);
+        if (kf_pool.stop)
+            break;
+        seen = kf_pool.generation;
+        fn = kf_pool.fn;
+        arg = kf_pool.arg;
+        ntasks = kf_pool.ntasks;
+        maxthreads = kf_pool.maxthreads;
+        KF_POOL_UNLOCK();
+
+        kf_pool_work(fn,arg,ntasks,maxthreads,worker);
+
+        KF_POOL_LOCK();
+        if (--kf_pool.pending == 0)
+            KF_POOL_SIGNAL(kf_pool_done);
+    }
+    KF_POOL_UNLOCK();
+}
+
+#if defined(_MSC_VER)
+static DWORD WINAPI kf_pool_main(LPVOID worker)
+{
+    kf_pool_worker((int)(INT_PTR)worker);
+    return 0;
+}
+#else
+static void * kf_pool_main(void * worker)
+{
+    kf_pool_worker((int)(intptr_t)worker);
+    return NULL;
+}
+#endif
+
+/* called with the pool idle and the busy lock held */
+static void kf_pool_start(void)
+{
+    int n = kf_pool_size();
+    int i;
+
+    kf_pool.stop = 0;
+    kf_pool.started = kf_pool.generation;
+    for (i=1;i<n;++i) {
+#if defined(_MSC_VER)
+        kf_pool.threads[i] = CreateThread(NULL,0,kf_pool_main,(LPVOID)(INT_PTR)i,0,NULL);
+        if (kf_pool.threads[i] == NULL)
+            break;
+#else
+        if (pthread_create(&kf_pool.threads[i],NULL,kf_pool_main,(void*)(intptr_t)i) != 0)
+            break;
+#endif
+    }
+    kf_pool.nthreads = i;
+}
+
+/* called with the busy lock held */
+static void kf_pool_stop(void)
+{
+    int i;
+
+    KF_POOL_LOCK();
+    kf_pool.stop = 1;
+    KF_POOL_BROADCAST(kf_pool_wake);
+    KF_POOL_UNLOCK();
+    for (i=1;i<kf_pool.nthreads;++i) {
+#if defined(_MSC_VER)
+        WaitForSingleObject(kf_pool.threads[i],INFINITE);
+        CloseHandle(kf_pool.threads[i]);
+#else
+        pthread_join(kf_pool.threads[i],NULL);
+#endif
+    }
+    kf_pool.nthreads = 0;
+}
+
+int kf_pool_size(void)
+{
+    int n = kf_pool.requested > 0 ? kf_pool.requested : kf_pool_processors();
+    return n < KF_POOL_MAX_THREADS ? n : KF_POOL_MAX_THREADS;
+}
+
+void kf_pool_prepare(void)
+{
+    /* waits for a running job to finish */
+    KF_POOL_BEGIN_BUSY();
+    if (kf_pool.nthreads == 0)
+        kf_pool_start();
+    KF_POOL_END_BUSY();
+}
+
+/* called with the busy lock held and the workers started */
+static void kf_pool_dispatch(kf_pool_fn fn,void * arg,int ntasks,int maxthreads)
+{
+    KF_POOL_LOCK();
+    kf_pool.fn = fn;
+    kf_pool.arg = arg;
+    kf_pool.ntasks = ntasks;
+    kf_pool.maxthreads = maxthreads;
+    KF_POOL_RESET(&kf_pool.next);
+    kf_pool.pending = kf_pool.nthreads - 1;
+    ++kf_pool.generation;
+    KF_POOL_BROADCAST(kf_pool_wake);
+    KF_POOL_UNLOCK();
+
+    kf_pool_work(fn,arg,ntasks,maxthreads,0);
+
+    KF_POOL_LOCK();
+    while (kf_pool.pending > 0)
+        KF_POOL_WAIT(kf_pool_done);
+    KF_POOL_UNLOCK();
+}
+
+void kf_pool_run(kf_pool_fn fn,void * arg,int ntasks,int maxthreads)
+{
+    int i;
+
+    if (KF_POOL_TRY_BUSY()) {
+        if (kf_pool.nthreads) {
+            kf_pool_dispatch(fn,arg,ntasks,maxthreads);
+            KF_POOL_END_BUSY();
+            return;
+        }
+        KF_POOL_END_BUSY();
+    }
+    /* busy with another job, or not started */
+    for (i=0;i<ntasks;++i)
+        fn(arg,i,0);
+}
+
+void kf_pool_shutdown(void)
+{
+    /* waits for a running job to finish */
+    KF_POOL_BEGIN_BUSY();
+    if (kf_pool.nthreads)
+        kf_pool_stop();
+    KF_POOL_END_BUSY();
+}
+
+void kiss_fft_set_threads(int nthreads)
+{
+    KF_POOL_BEGIN_BUSY();
+    if (kf_pool.nthreads)
+        kf_pool_stop();
+    kf_pool.requested = nthreads;
+    kf_pool_start();
+    KF_POOL_END_BUSY();
+}
@@ -0,0 +1,12 @@
+/*
+ The int16 symbol set of the core: kiss_fft, kiss_fftr and kfc with
+ every external name suffixed _s16 (see kiss_fft_sets.h).
+ */
+#define KISS_FFT_SET_S16
+#include "_kiss_fft_set.h"
+
+#include "kiss_fft.c"
+#include "kiss_fftr.c"
+#include "kfc.c"
+#include "kiss_fft_wisdom.c"
+#include "kiss_fft_simd.c"
@@ -0,0 +1,74 @@
+#ifndef KISS_FFT_SETS_H
+#define KISS_FFT_SETS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ Extra symbol sets.
+
+ kiss_fft_scalar is fixed when the library is built, so kiss_fft.h
+ describes one precision only. kiss_fft_f64.c and kiss_fft_s16.c build
+ the core a second and third time, with kiss_fft_scalar set to double
+ and to int16_t (FIXED_POINT=16), and every external name given the
+ suffix _f64 or _s16, so all three link into one program:
+
+     kiss_fft_alloc      kiss_fft_alloc_f64      kiss_fft_alloc_s16
+     kiss_fft_cpx        kiss_fft_cpx_f64        kiss_fft_cpx_s16
+     kfc_acquire_real    kfc_acquire_real_f64    kfc_acquire_real_s16
+
+ Each set behaves exactly like the default build of its precision and
+ keeps its own plan cache and wisdom. The worker pool of the parallel
+ executor and the allocator hooks are shared: kiss_fft_set_threads and
+ kiss_fft_set_allocator apply to all sets, and cfgs of every set are
+ released with kiss_fft_free. The double set has no SIMD butterflies.
+
+ This header declares the API of kiss_fft.h, kiss_fftr.h and kfc.h for
+ both sets. The batch and out-of-core transforms are float only.
+ */
+
+#define KISS_FFT_DECLARE_SET(sfx,scalar) \
+    typedef struct { scalar r; scalar i; } kiss_fft_cpx_##sfx; \
+    typedef struct kiss_fft_state_##sfx * kiss_fft_cfg_##sfx; \
+    typedef struct kiss_fftr_state_##sfx * kiss_fftr_cfg_##sfx; \
+    \
+    kiss_fft_cfg_##sfx kiss_fft_alloc_##sfx(int nfft,int inverse_fft,void * mem,size_t * lenmem); \
+    void kiss_fft_##sfx(kiss_fft_cfg_##sfx cfg,const kiss_fft_cpx_##sfx *fin,kiss_fft_cpx_##sfx *fout); \
+    void kiss_fft_stride_##sfx(kiss_fft_cfg_##sfx cfg,const kiss_fft_cpx_##sfx *fin,kiss_fft_cpx_##sfx *fout,int fin_stride); \
+    size_t kiss_fft_scratch_size_##sfx(kiss_fft_cfg_##sfx cfg); \
+    void kiss_fft_scratch_##sfx(kiss_fft_cfg_##sfx cfg,const kiss_fft_cpx_##sfx *fin,kiss_fft_cpx_##sfx *fout,void * scratch); \
+    int kiss_fft_simd_level_##sfx(void); \
+    void kiss_fft_set_simd_level_##sfx(kiss_fft_cfg_##sfx cfg,int level); \
+    void kiss_fft_set_executor_##sfx(kiss_fft_cfg_##sfx cfg,int executor); \
+    kiss_fft_cfg_##sfx kiss_fft_alloc_measured_##sfx(int nfft,int inverse_fft,void * mem,size_t * lenmem); \
+    int kiss_fft_export_wisdom_##sfx(const char * path); \
+    int kiss_fft_import_wisdom_##sfx(const char * path); \
+    void kiss_fft_forget_wisdom_##sfx(void); \
+    void kiss_fft_cleanup_##sfx(void); \
+    int kiss_fft_next_fast_size_##sfx(int n); \
+    \
+    kiss_fftr_cfg_##sfx kiss_fftr_alloc_##sfx(int nfft,int inverse_fft,void * mem,size_t * lenmem); \
+    void kiss_fftr_##sfx(kiss_fftr_cfg_##sfx cfg,const scalar *timedata,kiss_fft_cpx_##sfx *freqdata); \
+    void kiss_fftri_##sfx(kiss_fftr_cfg_##sfx cfg,const kiss_fft_cpx_##sfx *freqdata,scalar *timedata); \
+    size_t kiss_fftr_scratch_size_##sfx(kiss_fftr_cfg_##sfx cfg); \
+    void kiss_fftr_scratch_##sfx(kiss_fftr_cfg_##sfx cfg,const scalar *timedata,kiss_fft_cpx_##sfx *freqdata,void * scratch); \
+    void kiss_fftri_scratch_##sfx(kiss_fftr_cfg_##sfx cfg,const kiss_fft_cpx_##sfx *freqdata,scalar *timedata,void * scratch); \
+    \
+    kiss_fft_cfg_##sfx kfc_acquire_##sfx(int nfft,int inverse_fft); \
+    void kfc_release_##sfx(kiss_fft_cfg_##sfx cfg); \
+    kiss_fftr_cfg_##sfx kfc_acquire_real_##sfx(int nfft,int inverse_fft); \
+    void kfc_release_real_##sfx(kiss_fftr_cfg_##sfx cfg); \
+    void kfc_cleanup_##sfx(void);
+
+KISS_FFT_DECLARE_SET(f64,double)
+KISS_FFT_DECLARE_SET(s16,int16_t)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,293 @@
+/*
+ Runtime dispatched SSE2, AVX2 and AVX-512 butterflies for the float build.
+
+ The scalar butterflies in kiss_fft.c walk the m inner iterations of a
+ stage one complex value at a time. The kernels here process 2, 4 or 8
+ of those iterations per instruction on the interleaved kiss_fft_cpx
+ data, so a single transform speeds up without changing its layout.
+ Twiddles for stages deeper than the first are strided and are gathered
+ into a vector per iteration.
+
+ Each instruction set is compiled with a function level target attribute,
+ so the rest of the library needs no special compiler flags; kf_simd_detect
+ decides at runtime which of them the cpu and OS actually support.
+ */
+
+#include "_kiss_fft_guts.h"
+
+#ifdef KISS_FFT_HAVE_X86_SIMD
+
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+#if defined(__clang__) || ( defined(__GNUC__) && ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) ) )
+#  define KF_TARGET_SSE2 __attribute__((target("sse2")))
+#  define KF_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#  define KF_TARGET_AVX512 __attribute__((target("avx512f")))
+#  define KF_HAVE_AVX2 1
+#  if defined(__clang__) || __GNUC__ >= 5
+#    define KF_HAVE_AVX512 1
+#  endif
+#elif defined(_MSC_VER)
+#  define KF_TARGET_SSE2
+#  define KF_TARGET_AVX2
+#  define KF_TARGET_AVX512
+#  if _MSC_VER >= 1700
+#    define KF_HAVE_AVX2 1
+#  endif
+#  if _MSC_VER >= 1911
+#    define KF_HAVE_AVX512 1
+#  endif
+#else
+#  define KF_TARGET_SSE2
+#endif
+
+#if defined(KF_HAVE_AVX2) || defined(KF_HAVE_AVX512)
+#  include <immintrin.h>
+#endif
+
+/* SSE2: two complex values per __m128 */
+
+static KF_TARGET_SSE2 __m128 kf_sse2_loadtw(const kiss_fft_cpx * p,size_t s)
+{
+    if (s == 1)
+        return _mm_loadu_ps( (const float*)p );
+    return _mm_loadh_pi( _mm_loadl_pi( _mm_setzero_ps() , (const __m64*)p ) , (const __m64*)(p+s) );
+}
+
+static KF_TARGET_SSE2 __m128 kf_sse2_cmul(__m128 a,__m128 b)
+{
+    __m128 br = _mm_shuffle_ps(b,b,_MM_SHUFFLE(2,2,0,0));
+    __m128 bi = _mm_shuffle_ps(b,b,_MM_SHUFFLE(3,3,1,1));
+    __m128 as = _mm_shuffle_ps(a,a,_MM_SHUFFLE(2,3,0,1));
+    return _mm_add_ps( _mm_mul_ps(a,br) , _mm_xor_ps( _mm_mul_ps(as,bi) , _mm_set_ps(0.f,-0.f,0.f,-0.f) ) );
+}
+
+#define KF_V __m128
+#define KF_LEVEL KISS_FFT_SIMD_SSE2
+#define KF_W 2
+#define KF_NAME(x) kf_sse2_##x
+#define KF_TARGET KF_TARGET_SSE2
+#define KF_LOAD(p) _mm_loadu_ps( (const float*)(p) )
+#define KF_STORE(p,v) _mm_storeu_ps( (float*)(p) , v )
+#define KF_LOADTW(p,s) kf_sse2_loadtw(p,s)
+#define KF_BCAST(p) _mm_castpd_ps( _mm_load1_pd( (const double*)(p) ) )
+#define KF_ADD(a,b) _mm_add_ps(a,b)
+#define KF_SUB(a,b) _mm_sub_ps(a,b)
+#define KF_SCALE(a,s) _mm_mul_ps( a , _mm_set1_ps(s) )
+#define KF_CMUL(a,b) kf_sse2_cmul(a,b)
+#define KF_MULNI(a) _mm_xor_ps( _mm_shuffle_ps(a,a,_MM_SHUFFLE(2,3,0,1)) , _mm_set_ps(-0.f,0.f,-0.f,0.f) )
+#define KF_MULPI(a) _mm_xor_ps( _mm_shuffle_ps(a,a,_MM_SHUFFLE(2,3,0,1)) , _mm_set_ps(0.f,-0.f,0.f,-0.f) )
+#include "_kiss_fft_simd_bfly.h"
+#undef KF_V
+#undef KF_LEVEL
+#undef KF_W
+#undef KF_NAME
+#undef KF_TARGET
+#undef KF_LOAD
+#undef KF_STORE
+#undef KF_LOADTW
+#undef KF_BCAST
+#undef KF_ADD
+#undef KF_SUB
+#undef KF_SCALE
+#undef KF_CMUL
+#undef KF_MULNI
+#undef KF_MULPI
+
+#ifdef KF_HAVE_AVX2
+
+/* AVX2 + FMA: four complex values per __m256 */
+
+static KF_TARGET_AVX2 __m256 kf_avx2_loadtw(const kiss_fft_cpx * p,size_t s)
+{
+    __m128 lo,hi;
+    if (s == 1)
+        return _mm256_loadu_ps( (const float*)p );
+    lo = _mm_loadh_pi( _mm_loadl_pi( _mm_setzero_ps() , (const __m64*)p ) , (const __m64*)(p+s) );
+    hi = _mm_loadh_pi( _mm_loadl_pi( _mm_setzero_ps() , (const __m64*)(p+2*s) ) , (const __m64*)(p+3*s) );
+    return _mm256_insertf128_ps( _mm256_castps128_ps256(lo) , hi , 1 );
+}
+
+static KF_TARGET_AVX2 __m256 kf_avx2_cmul(__m256 a,__m256 b)
+{
+    return _mm256_fmaddsub_ps( a , _mm256_moveldup_ps(b) ,
+            _mm256_mul_ps( _mm256_permute_ps(a,0xB1) , _mm256_movehdup_ps(b) ) );
+}
+
+#define KF_V __m256
+#define KF_LEVEL KISS_FFT_SIMD_AVX2
+#define KF_W 4
+#define KF_NAME(x) kf_avx2_##x
+#define KF_TARGET KF_TARGET_AVX2
+#define KF_LOAD(p) _mm256_loadu_ps( (const float*)(p) )
+#define KF_STORE(p,v) _mm256_storeu_ps( (float*)(p) , v )
+#define KF_LOADTW(p,s) kf_avx2_loadtw(p,s)
+#define KF_BCAST(p) _mm256_castpd_ps( _mm256_broadcast_sd( (const double*)(p) ) )
+#define KF_ADD(a,b) _mm256_add_ps(a,b)
+#define KF_SUB(a,b) _mm256_sub_ps(a,b)
+#define KF_SCALE(a,s) _mm256_mul_ps( a , _mm256_set1_ps(s) )
+#define KF_CMUL(a,b) kf_avx2_cmul(a,b)
+#define KF_MULNI(a) _mm256_xor_ps( _mm256_permute_ps(a,0xB1) , _mm256_set_ps(-0.f,0.f,-0.f,0.f,-0.f,0.f,-0.f,0.f) )
+#define KF_MULPI(a) _mm256_xor_ps( _mm256_permute_ps(a,0xB1) , _mm256_set_ps(0.f,-0.f,0.f,-0.f,0.f,-0.f,0.f,-0.f) )
+#include "_kiss_fft_simd_bfly.h"
+#undef KF_V
+#undef KF_LEVEL
+#undef KF_W
+#undef KF_NAME
+#undef KF_TARGET
+#undef KF_LOAD
+#undef KF_STORE
+#undef KF_LOADTW
+#undef KF_BCAST
+#undef KF_ADD
+#undef KF_SUB
+#undef KF_SCALE
+#undef KF_CMUL
+#undef KF_MULNI
+#undef KF_MULPI
+
+#endif /* KF_HAVE_AVX2 */
+
+#ifdef KF_HAVE_AVX512
+
+/* AVX-512F: eight complex values per __m512 */
+
+static KF_TARGET_AVX512 __m512 kf_avx512_loadtw(const kiss_fft_cpx * p,size_t s)
+{
+    __m512i idx;
+    if (s == 1)
+        return _mm512_loadu_ps( (const float*)p );
+    idx = _mm512_set_epi64( 7*(long long)s, 6*(long long)s, 5*(long long)s, 4*(long long)s,
+                            3*(long long)s, 2*(long long)s, (long long)s, 0 );
+    /* each kiss_fft_cpx is gathered as one 64 bit lane */
+    return _mm512_castpd_ps( _mm512_i64gather_pd( idx , (const void*)p , 8 ) );
+}
+
+static KF_TARGET_AVX512 __m512 kf_avx512_cmul(__m512 a,__m512 b)
+{
+    return _mm512_fmaddsub_ps( a , _mm512_moveldup_ps(b) ,
+            _mm512_mul_ps( _mm512_permute_ps(a,0xB1) , _mm512_movehdup_ps(b) ) );
+}
+
+/* negate the real (even) or imaginary (odd) lanes */
+#define KF_AVX512_NEG_RE(a) _mm512_mask_sub_ps( a , 0x5555 , _mm512_setzero_ps() , a )
+#define KF_AVX512_NEG_IM(a) _mm512_mask_sub_ps( a , 0xAAAA , _mm512_setzero_ps() , a )
+
+#define KF_V __m512
+#define KF_LEVEL KISS_FFT_SIMD_AVX512
+#define KF_W 8
+#define KF_NAME(x) kf_avx512_##x
+#define KF_TARGET KF_TARGET_AVX512
+#define KF_LOAD(p) _mm512_loadu_ps( (const float*)(p) )
+#define KF_STORE(p,v) _mm512_storeu_ps( (float*)(p) , v )
+#define KF_LOADTW(p,s) kf_avx512_loadtw(p,s)
+#define KF_BCAST(p) _mm512_castpd_ps( _mm512_broadcastsd_pd( _mm_load_sd( (const double*)(p) ) ) )
+#define KF_ADD(a,b) _mm512_add_ps(a,b)
+#define KF_SUB(a,b) _mm512_sub_ps(a,b)
+#define KF_SCALE(a,s) _mm512_mul_ps( a , _mm512_set1_ps(s) )
+#define KF_CMUL(a,b) kf_avx512_cmul(a,b)
+#define KF_MULNI(a) KF_AVX512_NEG_IM( _mm512_permute_ps(a,0xB1) )
+#define KF_MULPI(a) KF_AVX512_NEG_RE( _mm512_permute_ps(a,0xB1) )
+#include "_kiss_fft_simd_bfly.h"
+#undef KF_V
+#undef KF_LEVEL
+#undef KF_W
+#undef KF_NAME
+#undef KF_TARGET
+#undef KF_LOAD
+#undef KF_STORE
+#undef KF_LOADTW
+#undef KF_BCAST
+#undef KF_ADD
+#undef KF_SUB
+#undef KF_SCALE
+#undef KF_CMUL
+#undef KF_MULNI
+#undef KF_MULPI
+
+#endif /* KF_HAVE_AVX512 */
+
+/* widest first */
+static const kf_simd_kernels * const kf_simd_table[] = {
+#ifdef KF_HAVE_AVX512
+    &kf_avx512_kernels,
+#endif
+#ifdef KF_HAVE_AVX2
+    &kf_avx2_kernels,
+#endif
+    &kf_sse2_kernels
+};
+
+int kf_simd_detect(void)
+{
+    int level = KISS_FFT_SIMD_NONE;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info,0);
+    if (info[0] >= 1) {
+        int max = info[0];
+        __cpuid(info,1);
+        if (info[3] & (1<<26))
+            level = KISS_FFT_SIMD_SSE2;
+#  if defined(KF_HAVE_AVX2) || defined(KF_HAVE_AVX512)
+        /* osxsave, avx and fma; then check the OS saves ymm (and zmm) state */
+        if (max >= 7 && (info[2] & (1<<27)) && (info[2] & (1<<28)) && (info[2] & (1<<12))) {
+            unsigned long long xcr0 = _xgetbv(0);
+            __cpuidex(info,7,0);
+#    ifdef KF_HAVE_AVX2
+            if ((xcr0 & 0x6) == 0x6 && (info[1] & (1<<5)))
+                level = KISS_FFT_SIMD_AVX2;
+#    endif
+#    ifdef KF_HAVE_AVX512
+            if ((xcr0 & 0xE6) == 0xE6 && (info[1] & (1<<16)))
+                level = KISS_FFT_SIMD_AVX512;
+#    endif
+        }
+#  else
+        (void)max;
+#  endif
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        level = KISS_FFT_SIMD_SSE2;
+#  ifdef KF_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        level = KISS_FFT_SIMD_AVX2;
+#  endif
+#  ifdef KF_HAVE_AVX512
+    if (__builtin_cpu_supports("avx512f"))
+        level = KISS_FFT_SIMD_AVX512;
+#  endif
+#endif
+    return level;
+}
+
+const kf_simd_kernels * kf_simd_select(int level,int m)
+{
+    size_t i;
+    for (i=0;i<sizeof(kf_simd_table)/sizeof(kf_simd_table[0]);++i) {
+        const kf_simd_kernels * k = kf_simd_table[i];
+        if (k->level <= level && m % k->width == 0)
+            return k;
+    }
+    return NULL;
+}
+
+#else /* KISS_FFT_HAVE_X86_SIMD */
+
+int kf_simd_detect(void)
+{
+    return KISS_FFT_SIMD_NONE;
+}
+
+const kf_simd_kernels * kf_simd_select(int level,int m)
+{
+    (void)level; (void)m;
+    return NULL;
+}
+
+#endif /* KISS_FFT_HAVE_X86_SIMD */
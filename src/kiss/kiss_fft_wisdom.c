@@ -0,0 +1,329 @@
+/* clock_gettime and CLOCK_MONOTONIC, which strict C99 builds do not
+   declare otherwise */
+#if !defined(_MSC_VER) && !defined(_POSIX_C_SOURCE)
+#  define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "_kiss_fft_guts.h"
+
+/*
+ Measuring planner and wisdom.
+
+ kiss_fft_alloc_measured times every candidate plan for a size: both
+ radix orders of kf_factor_order, every executor that applies, and every
+ SIMD level up to the cpu's. The fastest is recorded as wisdom, a list of
+ (nfft, direction, plan) entries that kiss_fft_alloc consults, so every
+ later plan of that size, including the substates of kiss_fftr and the
+ plans of the kfc cache, is built the same way.
+
+ Changes to the list are serialized by a process-wide mutex. Lookups
+ take no lock, so planning, a resize on an audio thread included, never
+ waits for an import reading its file: an entry is filled in before it
+ is published at the head of the list and never changes after. A
+ replaced or forgotten entry is unlinked but kept on a retired list, so
+ a lookup walking past it still follows valid links, and is freed only
+ by kiss_fft_cleanup.
+ */
+
+#if defined(_MSC_VER)
+#  include <windows.h>
+static SRWLOCK kf_wisdom_mutex = SRWLOCK_INIT;
+#  define KF_WISDOM_LOCK() AcquireSRWLockExclusive(&kf_wisdom_mutex)
+#  define KF_WISDOM_UNLOCK() ReleaseSRWLockExclusive(&kf_wisdom_mutex)
+#else
+#  include <pthread.h>
+#  include <time.h>
+static pthread_mutex_t kf_wisdom_mutex = PTHREAD_MUTEX_INITIALIZER;
+#  define KF_WISDOM_LOCK() pthread_mutex_lock(&kf_wisdom_mutex)
+#  define KF_WISDOM_UNLOCK() pthread_mutex_unlock(&kf_wisdom_mutex)
+#endif
+
+/* as in kfc.c */
+#if defined(_MSC_VER)
+#  define KF_WISDOM_LOAD(p) (*(p))
+#  define KF_WISDOM_PUBLISH(p,v) InterlockedExchangePointer((PVOID volatile *)(p),(PVOID)(v))
+#else
+#  define KF_WISDOM_LOAD(p) __atomic_load_n((p),__ATOMIC_ACQUIRE)
+#  define KF_WISDOM_PUBLISH(p,v) __atomic_store_n((p),(v),__ATOMIC_RELEASE)
+#endif
+
+/* first line of a wisdom file */
+#define KF_WISDOM_HEADER "kissfft-wisdom 1"
+
+/* as in kfc.c: wisdom of builds with different kiss_fft_scalar never mixes */
+#ifdef FIXED_POINT
+#  define KF_WISDOM_SCALAR ( (int)sizeof(kiss_fft_scalar)*2 + 1 )
+#else
+#  define KF_WISDOM_SCALAR ( (int)sizeof(kiss_fft_scalar)*2 )
+#endif
+
+/* shortest run of transforms a candidate is timed over, in seconds */
+#define KF_MEASURE_MIN 1e-3
+#define KF_MEASURE_TRIALS 3
+
+typedef struct kf_wisdom {
+    struct kf_wisdom * volatile next;
+    struct kf_wisdom * retired; /* next on the retired list */
+    int nfft;
+    int inverse;
+    kf_tuning tuning;
+} kf_wisdom;
+
+static kf_wisdom * volatile kf_wisdom_head = NULL;
+/* unlinked entries, freed by kf_wisdom_release; under the mutex */
+static kf_wisdom * kf_wisdom_retired = NULL;
+
+/* safe with or without the mutex */
+static kf_wisdom * kf_wisdom_find(int nfft,int inverse)
+{
+    kf_wisdom * w;
+    for (w = KF_WISDOM_LOAD(&kf_wisdom_head); w; w = KF_WISDOM_LOAD(&w->next))
+        if (w->nfft == nfft && w->inverse == inverse)
+            return w;
+    return NULL;
+}
+
+/* called with the mutex held; replaces an existing entry */
+static int kf_wisdom_store(int nfft,int inverse,const kf_tuning * tuning)
+{
+    kf_wisdom * w = (kf_wisdom*)KF_MALLOC(sizeof(kf_wisdom));
+    kf_wisdom * old = kf_wisdom_find(nfft,inverse);
+    kf_wisdom * volatile * link;
+
+    if (w == NULL)
+        return -1;
+    w->nfft = nfft;
+    w->inverse = inverse;
+    w->tuning = *tuning;
+    w->retired = NULL;
+    if (old) {
+        /* a lookup standing on old still reaches the rest of the list */
+        for (link = &kf_wisdom_head; *link != old; link = &(*link)->next)
+            ;
+        KF_WISDOM_PUBLISH(link,old->next);
+        old->retired = kf_wisdom_retired;
+        kf_wisdom_retired = old;
+    }
+    w->next = kf_wisdom_head;
+    KF_WISDOM_PUBLISH(&kf_wisdom_head,w);
+    return 0;
+}
+
+int kf_wisdom_lookup(int nfft,int inverse_fft,kf_tuning * tuning)
+{
+    const kf_wisdom * w = kf_wisdom_find(nfft,inverse_fft != 0);
+    if (w && tuning)
+        *tuning = w->tuning;
+    return w != NULL;
+}
+
+static double kf_now(void)
+{
+#if defined(_MSC_VER)
+    LARGE_INTEGER t,f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (double)t.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC,&t);
+    return t.tv_sec + t.tv_nsec*1e-9;
+#endif
+}
+
+/* seconds per transform: the best of a few runs, each long enough to time */
+static double kf_time(kiss_fft_cfg st,const kiss_fft_cpx * in,kiss_fft_cpx * out)
+{
+    double t,best = 0;
+    int reps = 1, trial, i;
+
+    /* warms the caches, and the thread pool of the parallel executor */
+    kiss_fft(st,in,out);
+    for (;;) {
+        t = kf_now();
+        for (i=0;i<reps;++i)
+            kiss_fft(st,in,out);
+        t = kf_now() - t;
+        if (t >= KF_MEASURE_MIN || reps >= (1<<20))
+            break;
+        reps *= 2;
+    }
+    best = t / reps;
+    for (trial=1;trial<KF_MEASURE_TRIALS;++trial) {
+        t = kf_now();
+        for (i=0;i<reps;++i)
+            kiss_fft(st,in,out);
+        t = (kf_now() - t) / reps;
+        if (t < best)
+            best = t;
+    }
+    return best;
+}
+
+/* whether two radix orders factor n the same way */
+static int kf_same_factors(const int * a,const int * b)
+{
+    int i;
+    for (i=0;;i+=2) {
+        if (a[i] != b[i])
+            return 0;
+        if (a[i+1] == 1)
+            return 1;
+    }
+}
+
+static int kf_measure(int nfft,int inverse,kf_tuning * best)
+{
+    static const int executors[] = {
+        KISS_FFT_EXEC_RECURSIVE, KISS_FFT_EXEC_STOCKHAM,
+        KISS_FFT_EXEC_PARALLEL, KISS_FFT_EXEC_SIXSTEP
+    };
+    int factors[2][2*MAXFACTORS];
+    kiss_fft_cpx * in;
+    kiss_fft_cpx * out;
+    double tbest = -1;
+    int order,e,level;
+
+    in = (kiss_fft_cpx*)KF_MALLOC(sizeof(kiss_fft_cpx)*nfft*2);
+    if (in == NULL)
+        return -1;
+    out = in + nfft;
+    memset(in,0,sizeof(kiss_fft_cpx)*nfft);
+
+    kf_factor_order(nfft,factors[KF_ORDER_RADIX8],KF_ORDER_RADIX8);
+    kf_factor_order(nfft,factors[KF_ORDER_RADIX4],KF_ORDER_RADIX4);
+    for (order=KF_ORDER_RADIX8;order<=KF_ORDER_RADIX4;++order) {
+        kf_tuning cand;
+        kiss_fft_cfg st;
+
+        if (order != KF_ORDER_RADIX8 && kf_same_factors(factors[order],factors[KF_ORDER_RADIX8]))
+            continue;
+        cand.order = order;
+        cand.executor = KISS_FFT_EXEC_RECURSIVE;
+        cand.simd = kiss_fft_simd_level();
+        st = kf_alloc_tuned(nfft,inverse,NULL,NULL,&cand);
+        if (st == NULL)
+            continue;
+        for (e=0;e<(int)(sizeof(executors)/sizeof(executors[0]));++e) {
+            cand.executor = executors[e];
+            if (cand.executor == KISS_FFT_EXEC_PARALLEL
+                    && (nfft < KISS_FFT_PARALLEL_MIN || kf_pool_size() < 2))
+                continue;
+            if (cand.executor == KISS_FFT_EXEC_SIXSTEP && st->sixstep[0] == NULL)
+                continue;
+            kiss_fft_set_executor(st,cand.executor);
+            for (level=kiss_fft_simd_level();level>=KISS_FFT_SIMD_NONE;--level) {
+                double t;
+                cand.simd = level;
+                kiss_fft_set_simd_level(st,level);
+                t = kf_time(st,in,out);
+                if (tbest < 0 || t < tbest) {
+                    tbest = t;
+                    *best = cand;
+                }
+            }
+        }
+        kiss_fft_free(st);
+    }
+    kiss_fft_free(in);
+    return tbest < 0 ? -1 : 0;
+}
+
+kiss_fft_cfg kiss_fft_alloc_measured(int nfft,int inverse_fft,void * mem,size_t * lenmem)
+{
+    kf_tuning tuning;
+
+    inverse_fft = inverse_fft != 0;
+    if (!kf_wisdom_lookup(nfft,inverse_fft,&tuning)) {
+        if (kf_measure(nfft,inverse_fft,&tuning) != 0)
+            return kf_alloc_tuned(nfft,inverse_fft,mem,lenmem,NULL);
+        KF_WISDOM_LOCK();
+        kf_wisdom_store(nfft,inverse_fft,&tuning);
+        KF_WISDOM_UNLOCK();
+    }
+    return kf_alloc_tuned(nfft,inverse_fft,mem,lenmem,&tuning);
+}
+
+int kiss_fft_export_wisdom(const char * path)
+{
+    FILE * f = fopen(path,"w");
+    kf_wisdom * w;
+    int ok;
+
+    if (f == NULL)
+        return -1;
+    fprintf(f,"%s\n# nfft inverse scalar order executor simd\n",KF_WISDOM_HEADER);
+    KF_WISDOM_LOCK();
+    for (w = kf_wisdom_head; w; w = w->next)
+        fprintf(f,"%d %d %d %d %d %d\n",w->nfft,w->inverse,KF_WISDOM_SCALAR,
+                w->tuning.order,w->tuning.executor,w->tuning.simd);
+    KF_WISDOM_UNLOCK();
+    ok = !ferror(f);
+    if (fclose(f) != 0)
+        ok = 0;
+    return ok ? 0 : -1;
+}
+
+int kiss_fft_import_wisdom(const char * path)
+{
+    FILE * f = fopen(path,"r");
+    char line[128];
+    int ret = 0;
+
+    if (f == NULL)
+        return -1;
+    if (fgets(line,sizeof(line),f) == NULL
+            || strncmp(line,KF_WISDOM_HEADER,strlen(KF_WISDOM_HEADER)) != 0) {
+        fclose(f);
+        return -1;
+    }
+    KF_WISDOM_LOCK();
+    while (fgets(line,sizeof(line),f)) {
+        int nfft,inverse,scalar;
+        kf_tuning t;
+
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+        if (sscanf(line,"%d %d %d %d %d %d",&nfft,&inverse,&scalar,&t.order,&t.executor,&t.simd) != 6
+                || nfft < 1 || (inverse != 0 && inverse != 1)
+                || (t.order != KF_ORDER_RADIX8 && t.order != KF_ORDER_RADIX4)
+                || t.executor < KISS_FFT_EXEC_RECURSIVE || t.executor > KISS_FFT_EXEC_SIXSTEP
+                || t.simd < KISS_FFT_SIMD_NONE) {
+            ret = -1;
+            break;
+        }
+        /* entries measured by other builds are skipped */
+        if (scalar == KF_WISDOM_SCALAR && kf_wisdom_store(nfft,inverse,&t) != 0) {
+            ret = -1;
+            break;
+        }
+    }
+    KF_WISDOM_UNLOCK();
+    fclose(f);
+    return ret;
+}
+
+void kiss_fft_forget_wisdom(void)
+{
+    kf_wisdom * w;
+
+    KF_WISDOM_LOCK();
+    for (w = kf_wisdom_head; w; w = w->next) {
+        w->retired = kf_wisdom_retired;
+        kf_wisdom_retired = w;
+    }
+    KF_WISDOM_PUBLISH(&kf_wisdom_head,NULL);
+    KF_WISDOM_UNLOCK();
+}
+
+void kf_wisdom_release(void)
+{
+    kiss_fft_forget_wisdom();
+    KF_WISDOM_LOCK();
+    while (kf_wisdom_retired) {
+        kf_wisdom * w = kf_wisdom_retired;
+        kf_wisdom_retired = w->retired;
+        kiss_fft_free(w);
+    }
+    KF_WISDOM_UNLOCK();
+}
@@ -30,17 +30,19 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenme
     kiss_fftr_cfg st = NULL;
     size_t subsize, memneeded;
 
+    /* the plan serves both directions; see kiss_fftri */
+    (void)inverse_fft;
     if (nfft & 1) {
         fprintf(stderr,"Real FFT optimization must be even.\n");
         return NULL;
     }
     nfft >>= 1;
 
-    kiss_fft_alloc (nfft, inverse_fft, NULL, &subsize);
+    kiss_fft_alloc (nfft, 0, NULL, &subsize);
     memneeded = sizeof(struct kiss_fftr_state) + subsize + sizeof(kiss_fft_cpx) * ( nfft * 3 / 2);
 
     if (lenmem == NULL) {
-        st = (kiss_fftr_cfg) KISS_FFT_MALLOC (memneeded);
+        st = (kiss_fftr_cfg) KF_MALLOC (memneeded);
     } else {
         if (*lenmem >= memneeded)
             st = (kiss_fftr_cfg) mem;
@@ -52,34 +54,40 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenme
     st->substate = (kiss_fft_cfg) (st + 1); /*just beyond kiss_fftr_state struct */
     st->tmpbuf = (kiss_fft_cpx *) (((char *) st->substate) + subsize);
     st->super_twiddles = st->tmpbuf + nfft;
-    kiss_fft_alloc(nfft, inverse_fft, st->substate, &subsize);
-
-    for (i = 0; i < nfft/2; ++i) {
-        double phase =
-            -3.14159265358979323846264338327 * ((double) (i+1) / nfft + .5);
-        if (inverse_fft)
-            phase *= -1;
-        kf_cexp (st->super_twiddles+i,phase);
+    /* both directions run the forward transform; kiss_fftri conjugates around it */
+    kiss_fft_alloc(nfft, 0, st->substate, &subsize);
+    /* the iterative executor's work buffers come from the caller's scratch
+       in kiss_fftr_scratch, like tmpbuf, so a shared cfg stays reentrant;
+       sizes large enough for the six-step executor keep it, and so do
+       sizes with wisdom from the measuring planner */
+    if (st->substate->executor == KISS_FFT_EXEC_RECURSIVE && !kf_wisdom_lookup(nfft,0,NULL))
+        kiss_fft_set_executor(st->substate, KISS_FFT_EXEC_STOCKHAM);
+
+    /* exp(-i*pi*((i+1)/nfft + 1/2)) is the twiddle nfft/2+1+i of 2*nfft */
+    if (nfft % 2 == 0) {
+        kf_twiddles(st->super_twiddles, 2*nfft, nfft/2+1, nfft/2, 0);
+    } else {
+        for (i = 0; i < nfft/2; ++i) {
+            double phase =
+                -3.14159265358979323846264338327 * ((double) (i+1) / nfft + .5);
+            kf_cexp (st->super_twiddles+i,phase);
+        }
     }
     return st;
 }
 
-void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata)
+/* tmpbuf holds ncfft points, work the kiss_fft_scratch_size of the substate */
+static void kf_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,kiss_fft_cpx *tmpbuf,kiss_fft_cpx *work)
 {
     /* input buffer timedata is stored row-wise */
     int k,ncfft;
     kiss_fft_cpx fpnk,fpk,f1k,f2k,tw,tdc;
 
-    if ( st->substate->inverse) {
-        fprintf(stderr,"kiss fft usage error: improper alloc\n");
-        exit(1);
-    }
-
     ncfft = st->substate->nfft;
 
     /*perform the parallel fft of two real signals packed in real,imag*/
-    kiss_fft( st->substate , (const kiss_fft_cpx*)timedata, st->tmpbuf );
-    /* The real part of the DC element of the frequency spectrum in st->tmpbuf
+    kf_stride_work( st->substate , (const kiss_fft_cpx*)timedata, tmpbuf, 1, work );
+    /* The real part of the DC element of the frequency spectrum in tmpbuf
      * contains the sum of the even-numbered elements of the input time sequence
      * The imag part is the sum of the odd-numbered elements
      *
@@ -89,8 +97,8 @@ void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *fr
      *      yielding Nyquist bin of input time sequence
      */
  
-    tdc.r = st->tmpbuf[0].r;
-    tdc.i = st->tmpbuf[0].i;
+    tdc.r = tmpbuf[0].r;
+    tdc.i = tmpbuf[0].i;
     C_FIXDIV(tdc,2);
     CHECK_OVERFLOW_OP(tdc.r ,+, tdc.i);
     CHECK_OVERFLOW_OP(tdc.r ,-, tdc.i);
@@ -103,9 +111,9 @@ void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *fr
 #endif
 
     for ( k=1;k <= ncfft/2 ; ++k ) {
-        fpk    = st->tmpbuf[k]; 
-        fpnk.r =   st->tmpbuf[ncfft-k].r;
-        fpnk.i = - st->tmpbuf[ncfft-k].i;
+        fpk    = tmpbuf[k]; 
+        fpnk.r =   tmpbuf[ncfft-k].r;
+        fpnk.i = - tmpbuf[ncfft-k].i;
         C_FIXDIV(fpk,2);
         C_FIXDIV(fpnk,2);
 
@@ -120,40 +128,78 @@ void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *fr
     }
 }
 
-void kiss_fftri(kiss_fftr_cfg st,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata)
+static void kf_fftri(kiss_fftr_cfg st,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata,kiss_fft_cpx *tmpbuf,kiss_fft_cpx *work)
 {
     /* input buffer timedata is stored row-wise */
     int k, ncfft;
-
-    if (st->substate->inverse == 0) {
-        fprintf (stderr, "kiss fft usage error: improper alloc\n");
-        exit (1);
-    }
+    kiss_fft_cpx * tout = (kiss_fft_cpx *) timedata;
 
     ncfft = st->substate->nfft;
 
-    st->tmpbuf[0].r = freqdata[0].r + freqdata[ncfft].r;
-    st->tmpbuf[0].i = freqdata[0].r - freqdata[ncfft].r;
-    C_FIXDIV(st->tmpbuf[0],2);
+    /* The inverse transform is conj(FFT(conj(Z))) on the forward plan:
+     * tmpbuf is built already conjugated, and the super twiddles are
+     * conjugated as they are used. */
+    tmpbuf[0].r = freqdata[0].r + freqdata[ncfft].r;
+    tmpbuf[0].i = freqdata[ncfft].r - freqdata[0].r;
+    C_FIXDIV(tmpbuf[0],2);
 
     for (k = 1; k <= ncfft / 2; ++k) {
-        kiss_fft_cpx fk, fnkc, fek, fok, tmp;
+        kiss_fft_cpx fk, fnkc, fek, fok, tmp, twc;
         fk = freqdata[k];
         fnkc.r = freqdata[ncfft - k].r;
         fnkc.i = -freqdata[ncfft - k].i;
         C_FIXDIV( fk , 2 );
         C_FIXDIV( fnkc , 2 );
 
+        twc.r = st->super_twiddles[k-1].r;
+        twc.i = -st->super_twiddles[k-1].i;
         C_ADD (fek, fk, fnkc);
         C_SUB (tmp, fk, fnkc);
-        C_MUL (fok, tmp, st->super_twiddles[k-1]);
-        C_ADD (st->tmpbuf[k],     fek, fok);
-        C_SUB (st->tmpbuf[ncfft - k], fek, fok);
+        C_MUL (fok, tmp, twc);
+        C_ADD (tmpbuf[k],     fek, fok);
 #ifdef USE_SIMD        
-        st->tmpbuf[ncfft - k].i *= _mm_set1_ps(-1.0);
+        tmpbuf[k].i *= _mm_set1_ps(-1.0);
 #else
-        st->tmpbuf[ncfft - k].i *= -1;
+        tmpbuf[k].i *= -1;
 #endif
+        /* for k == ncfft/2 this overwrites the line above, as it should */
+        C_SUB (tmpbuf[ncfft - k], fek, fok);
     }
-    kiss_fft (st->substate, st->tmpbuf, (kiss_fft_cpx *) timedata);
+    kf_stride_work (st->substate, tmpbuf, tout, 1, work);
+
+    /* conjugate the result, i.e. negate the odd output samples */
+    for (k = 0; k < ncfft; ++k) {
+#ifdef USE_SIMD        
+        tout[k].i *= _mm_set1_ps(-1.0);
+#else
+        tout[k].i = -tout[k].i;
+#endif
+    }
+}
+
+void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata)
+{
+    kf_fftr(st,timedata,freqdata,st->tmpbuf,st->substate->work);
+}
+
+void kiss_fftri(kiss_fftr_cfg st,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata)
+{
+    kf_fftri(st,freqdata,timedata,st->tmpbuf,st->substate->work);
+}
+
+size_t kiss_fftr_scratch_size(kiss_fftr_cfg st)
+{
+    return sizeof(kiss_fft_cpx) * st->substate->nfft + kiss_fft_scratch_size(st->substate);
+}
+
+void kiss_fftr_scratch(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,void * scratch)
+{
+    kiss_fft_cpx * tmpbuf = (kiss_fft_cpx *) scratch;
+    kf_fftr(st,timedata,freqdata,tmpbuf,tmpbuf + st->substate->nfft);
+}
+
+void kiss_fftri_scratch(kiss_fftr_cfg st,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata,void * scratch)
+{
+    kiss_fft_cpx * tmpbuf = (kiss_fft_cpx *) scratch;
+    kf_fftri(st,freqdata,timedata,tmpbuf,tmpbuf + st->substate->nfft);
 }
@@ -23,6 +23,10 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem, size_t * lenm
  nfft must be even
 
  If you don't care to allocate space, use mem = lenmem = NULL 
+
+ The cfg holds only forward twiddles and serves both kiss_fftr and
+ kiss_fftri; the inverse conjugates around the forward transform.
+ inverse_fft is accepted for compatibility and has no effect.
 */
 
 
@@ -38,7 +42,22 @@ void kiss_fftri(kiss_fftr_cfg cfg,const kiss_fft_cpx *freqdata,kiss_fft_scalar *
  output timedata has nfft scalar points
 */
 
-#define kiss_fftr_free free
+/*
+ Reentrant variants of kiss_fftr and kiss_fftri.
+
+ The two functions above work in a buffer inside the cfg, so one cfg
+ can only run one transform at a time. These take that work space from
+ the caller instead and only read the cfg, so any number of threads
+ may share one cfg as long as each passes its own scratch.
+
+ scratch must hold kiss_fftr_scratch_size(cfg) bytes, a multiple of
+ sizeof(kiss_fft_cpx), and be aligned like a kiss_fft_cpx.
+*/
+size_t kiss_fftr_scratch_size(kiss_fftr_cfg cfg);
+void kiss_fftr_scratch(kiss_fftr_cfg cfg,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,void * scratch);
+void kiss_fftri_scratch(kiss_fftr_cfg cfg,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata,void * scratch);
+
+#define kiss_fftr_free kiss_fft_free
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,661 @@
+/*
+*
+* Copyright (c) 2012, Ban the Rewind
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or
+* without modification, are permitted provided that the following
+* conditions are met:
+*
+* Redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in
+* the documentation and/or other materials provided with the
+* distribution.
+*
+* Neither the name of the Ban the Rewind nor the names of its
+* contributors may be used to endorse or promote products
+* derived from this software without specific prior written
+* permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+* STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+* ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+*/
+
+// Checks of the wrapper against the spectra the original Kiss
+// class computed: the signal windowed by sin( pi * i / ( n - 1 ) ),
+// transformed, and scaled by 2 / the sum of the window. The
+// reference repeats that in double with a naive DFT. Also covers
+// 16 and 24-bit PCM input, downmixing, borrowed input, resizing, reserve(), moves, the filter,
+// KissStereo and KissBatch against one Kiss per channel and, with
+// C++14, KissFixed.
+//
+// There is no build system. From the root of the repository, with
+// the include directory of Cinder for cinder/CinderMath.h:
+//
+//     gcc -O2 -Isrc/kiss -c src/kiss/[a-z]*.c
+//     g++ -std=c++14 -O2 -I<cinder>/include -Isrc test/test_kiss.cpp src/KissFFT.cpp *.o -lpthread -o test_kiss
+//
+// Each failed check prints a line; the exit code is the number of
+// failures.
+
+// Includes
+#include "KissFFT.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Imports
+using namespace std;
+
+static int sChecks		= 0;
+static int sFailures	= 0;
+
+static void expect( bool ok, const char *what, int32_t dataSize, double err )
+{
+	++sChecks;
+	if ( !ok ) {
+		++sFailures;
+		printf( "FAIL %s dataSize=%d err=%g\n", what, dataSize, err );
+	}
+}
+
+// A few partials and some noise
+static vector<double> makeSignal( int32_t dataSize )
+{
+	vector<double> signal( dataSize );
+	for ( int32_t i = 0; i < dataSize; ++i ) {
+		signal[ i ] = 0.5 * sin( i * 0.37 ) + 0.25 * cos( i * 1.3 + 0.5 ) + 0.1 * ( rand() / (double)RAND_MAX - 0.5 );
+	}
+	return signal;
+}
+
+// The spectrum of the original Kiss, in double
+struct Reference
+{
+	Reference( const vector<double> &signal, float frequencyLow = 0.0f, float frequencyHigh = 1.0f )
+	{
+		const int32_t dataSize	= (int32_t)signal.size();
+		const int32_t binSize	= dataSize / 2 + 1;
+		double windowSum		= 0.0;
+		vector<double> windowed( dataSize );
+		for ( int32_t i = 0; i < dataSize; ++i ) {
+			double window = sin( ( M_PI * i ) / ( dataSize - 1 ) );
+			windowSum += window;
+			windowed[ i ] = signal[ i ] * window;
+		}
+		mReal.resize( binSize );
+		mImag.resize( binSize );
+		mAmplitude.resize( binSize );
+		mPhase.resize( binSize );
+		mMaxAmplitude = 0.0;
+		for ( int32_t k = 0; k < binSize; ++k ) {
+			double re = 0.0;
+			double im = 0.0;
+			if ( k >= frequencyLow * binSize && k <= frequencyHigh * binSize ) {
+				for ( int32_t i = 0; i < dataSize; ++i ) {
+					double phase = -2.0 * M_PI * (double)( ( (int64_t)i * k ) % dataSize ) / dataSize;
+					re += windowed[ i ] * cos( phase );
+					im += windowed[ i ] * sin( phase );
+				}
+			}
+			mReal[ k ]		= re * 2.0 / windowSum;
+			mImag[ k ]		= im * 2.0 / windowSum;
+			mAmplitude[ k ]	= sqrt( mReal[ k ] * mReal[ k ] + mImag[ k ] * mImag[ k ] );
+			mPhase[ k ]		= atan2( mImag[ k ], mReal[ k ] );
+			mMaxAmplitude	= max( mMaxAmplitude, mAmplitude[ k ] );
+		}
+	}
+
+	// Largest difference from the spectrum of kiss, relative to the
+	// largest amplitude. Phases are compared where the amplitude
+	// is large enough for them to mean anything
+	template<typename Instance>
+	double error( Instance &kiss ) const
+	{
+		double err = 0.0;
+		const auto *real		= kiss.getReal();
+		const auto *imag		= kiss.getImaginary();
+		const auto *amplitude	= kiss.getAmplitude();
+		const auto *phase		= kiss.getPhase();
+		for ( size_t k = 0; k < mReal.size(); ++k ) {
+			err = max( err, fabs( real[ k ] - mReal[ k ] ) / mMaxAmplitude );
+			err = max( err, fabs( imag[ k ] - mImag[ k ] ) / mMaxAmplitude );
+			err = max( err, fabs( amplitude[ k ] - mAmplitude[ k ] ) / mMaxAmplitude );
+			if ( mAmplitude[ k ] > 0.01 * mMaxAmplitude ) {
+				double d = fabs( phase[ k ] - mPhase[ k ] );
+				err = max( err, min( d, 2.0 * M_PI - d ) * 0.01 );
+			}
+		}
+		return err;
+	}
+
+	double			mMaxAmplitude;
+	vector<double>	mAmplitude;
+	vector<double>	mImag;
+	vector<double>	mPhase;
+	vector<double>	mReal;
+};
+
+// Samples of signal as Scalar, and the signal they stand for
+template<typename Scalar>
+static vector<Scalar> toSamples( vector<double> &signal )
+{
+	vector<Scalar> samples( signal.size() );
+	for ( size_t i = 0; i < signal.size(); ++i ) {
+		samples[ i ] = (Scalar)signal[ i ];
+	}
+	return samples;
+}
+
+template<>
+vector<int16_t> toSamples<int16_t>( vector<double> &signal )
+{
+	vector<int16_t> samples( signal.size() );
+	for ( size_t i = 0; i < signal.size(); ++i ) {
+		samples[ i ] = (int16_t)floor( signal[ i ] * 32767.0 + 0.5 );
+		signal[ i ] = samples[ i ] / 32768.0;
+	}
+	return samples;
+}
+
+// Spectra of one instance against the reference. Unless
+// signalTolerance is 0, the signal is then given again as the second
+// channel of interleaved float frames, which getData() recovers with
+// the inverse transform; it is compared away from the zero ends of
+// the window
+template<typename Scalar>
+static void checkSpectrum( KissT<Scalar> &kiss, const char *what, double tolerance, double signalTolerance )
+{
+	const int32_t dataSize	= kiss.getDataSize();
+	vector<double> signal	= makeSignal( dataSize );
+	vector<Scalar> samples	= toSamples<Scalar>( signal );
+	kiss.setData( &samples[ 0 ] );
+	double err = Reference( signal ).error( kiss );
+	expect( err <= tolerance, what, dataSize, err );
+
+	if ( signalTolerance > 0.0 ) {
+		vector<float> frames( dataSize * 2 );
+		for ( int32_t i = 0; i < dataSize; ++i ) {
+			frames[ i * 2 ]		= 1.0f;
+			frames[ i * 2 + 1 ]	= (float)signal[ i ];
+			signal[ i ]			= frames[ i * 2 + 1 ];
+		}
+		kiss.setData( &frames[ 0 ], 2, 1 );
+		err = Reference( signal ).error( kiss );
+		expect( err <= tolerance, "interleaved", dataSize, err );
+
+		const Scalar *data = kiss.getData();
+		err = 0.0;
+		for ( int32_t i = dataSize / 8; i < dataSize - dataSize / 8; ++i ) {
+			err = max( err, fabs( data[ i ] - signal[ i ] ) );
+		}
+		expect( err <= signalTolerance, "inverse", dataSize, err );
+	}
+}
+
+// Largest difference of one channel's spectrum from that of a Kiss
+// given the same signal, relative to its largest amplitude
+static double channelError( Kiss &kiss, const float *real, const float *imag, const float *amplitude, const float *phase )
+{
+	const float *kissAmplitude	= kiss.getAmplitude();
+	const float *kissImag		= kiss.getImaginary();
+	const float *kissPhase		= kiss.getPhase();
+	const float *kissReal		= kiss.getReal();
+	double maxAmplitude = 0.0;
+	for ( int32_t k = 0; k < kiss.getBinSize(); ++k ) {
+		maxAmplitude = max( maxAmplitude, (double)kissAmplitude[ k ] );
+	}
+	double err = 0.0;
+	for ( int32_t k = 0; k < kiss.getBinSize(); ++k ) {
+		err = max( err, fabs( real[ k ] - kissReal[ k ] ) / maxAmplitude );
+		err = max( err, fabs( imag[ k ] - kissImag[ k ] ) / maxAmplitude );
+		err = max( err, fabs( amplitude[ k ] - kissAmplitude[ k ] ) / maxAmplitude );
+		if ( kissAmplitude[ k ] > 0.01 * maxAmplitude ) {
+			double d = fabs( phase[ k ] - kissPhase[ k ] );
+			err = max( err, min( d, 2.0 * M_PI - d ) * 0.01 );
+		}
+	}
+	return err;
+}
+
+// Counts the allocations of the instances using it
+class CountingResource : public KissMemoryResource
+{
+
+public:
+
+	CountingResource()
+		: mCount( 0 ) {}
+
+	void* allocate( size_t bytes, size_t alignment )
+	{
+		++mCount;
+		return KissMemoryResource::getDefault()->allocate( bytes, alignment );
+	}
+
+	void deallocate( void *p, size_t bytes, size_t alignment )
+	{
+		KissMemoryResource::getDefault()->deallocate( p, bytes, alignment );
+	}
+
+	int32_t		mCount;
+
+};
+
+static void testPrecisions()
+{
+	const int32_t sizes[] = { 16, 30, 512, 1000, 2018, 2048, 4096, 4100 };
+	for ( size_t s = 0; s < sizeof( sizes ) / sizeof( sizes[ 0 ] ); ++s ) {
+		Kiss kiss( sizes[ s ] );
+		KissDouble kissDouble( sizes[ s ] );
+		checkSpectrum( kiss, "float", 1e-5, 1e-4 );
+		checkSpectrum( kissDouble, "double", 1e-12, 1e-10 );
+	}
+
+	// The fixed point core keeps 10 to 12 bits of the spectrum
+	const int32_t fixedSizes[] = { 16, 512, 1000, 2048 };
+	for ( size_t s = 0; s < sizeof( fixedSizes ) / sizeof( fixedSizes[ 0 ] ); ++s ) {
+		KissInt16 kissInt16( fixedSizes[ s ] );
+		checkSpectrum( kissInt16, "int16_t", 1e-2, 0.0 );
+	}
+}
+
+// Samples of signal at full scale fullScale, every seventh at
+// negative full scale, and the signal they stand for
+static vector<int32_t> toPcm( vector<double> &signal, int32_t fullScale )
+{
+	vector<int32_t> pcm( signal.size() );
+	for ( size_t i = 0; i < signal.size(); ++i ) {
+		pcm[ i ]	= i % 7 == 3 ? -fullScale : (int32_t)floor( signal[ i ] * ( fullScale - 1 ) + 0.5 );
+		signal[ i ]	= pcm[ i ] / (double)fullScale;
+	}
+	return pcm;
+}
+
+static void testPcm()
+{
+	// The signal is the second of two channels; the first holds
+	// positive full scale, which shows if it is read instead
+	const int32_t dataSize = 1024;
+	{
+		vector<double> signal	= makeSignal( dataSize );
+		vector<int32_t> pcm		= toPcm( signal, 32768 );
+		vector<int16_t> frames( dataSize * 2 );
+		for ( int32_t i = 0; i < dataSize; ++i ) {
+			frames[ i * 2 ]		= 32767;
+			frames[ i * 2 + 1 ]	= (int16_t)pcm[ i ];
+		}
+		Reference reference( signal );
+		Kiss kiss( dataSize );
+		kiss.setData( &frames[ 0 ], 2, 1 );
+		double err = reference.error( kiss );
+		expect( err <= 1e-5, "int16_t PCM", dataSize, err );
+		KissDouble kissDouble( dataSize );
+		kissDouble.setData( &frames[ 0 ], 2, 1 );
+		err = reference.error( kissDouble );
+		expect( err <= 1e-12, "int16_t PCM double", dataSize, err );
+	}
+
+	// Packed little-endian, so the sign of negative samples is in
+	// the top bit of the third byte
+	{
+		vector<double> signal	= makeSignal( dataSize );
+		vector<int32_t> pcm		= toPcm( signal, 8388608 );
+		vector<KissInt24> frames( dataSize * 2 );
+		for ( int32_t i = 0; i < dataSize; ++i ) {
+			uint32_t bits = (uint32_t)pcm[ i ];
+			for ( int32_t b = 0; b < 3; ++b ) {
+				frames[ i * 2 ].bytes[ b ]		= b == 2 ? 0x7f : 0xff;
+				frames[ i * 2 + 1 ].bytes[ b ]	= (uint8_t)( bits >> ( 8 * b ) );
+			}
+		}
+		Reference reference( signal );
+		Kiss kiss( dataSize );
+		kiss.setData( &frames[ 0 ], 2, 1 );
+		double err = reference.error( kiss );
+		expect( err <= 1e-5, "KissInt24 PCM", dataSize, err );
+		KissDouble kissDouble( dataSize );
+		kissDouble.setData( &frames[ 0 ], 2, 1 );
+		err = reference.error( kissDouble );
+		expect( err <= 1e-12, "KissInt24 PCM double", dataSize, err );
+	}
+}
+
+static void testDownmix()
+{
+	// Channel::DOWNMIX transforms the average of the channels
+	const int32_t dataSize		= 1024;
+	const int32_t channelCount	= 3;
+	vector<double> mix( dataSize );
+	vector<float> frames( dataSize * channelCount );
+	vector<int16_t> pcm( dataSize * channelCount );
+	for ( int32_t c = 0; c < channelCount; ++c ) {
+		vector<double> signal = makeSignal( dataSize );
+		for ( int32_t i = 0; i < dataSize; ++i ) {
+			frames[ i * channelCount + c ]	= (float)signal[ i ];
+			pcm[ i * channelCount + c ]		= c == 0 && i % 7 == 3 ? -32768 : (int16_t)floor( signal[ i ] * 32767.0 + 0.5 );
+		}
+	}
+
+	for ( int32_t i = 0; i < dataSize; ++i ) {
+		mix[ i ] = 0.0;
+		for ( int32_t c = 0; c < channelCount; ++c ) {
+			mix[ i ] += frames[ i * channelCount + c ];
+		}
+		mix[ i ] /= channelCount;
+	}
+	Kiss kiss( dataSize );
+	kiss.setData( &frames[ 0 ], channelCount, Kiss::Channel::DOWNMIX );
+	double err = Reference( mix ).error( kiss );
+	expect( err <= 1e-5, "downmix", dataSize, err );
+
+	for ( int32_t i = 0; i < dataSize; ++i ) {
+		mix[ i ] = 0.0;
+		for ( int32_t c = 0; c < channelCount; ++c ) {
+			mix[ i ] += pcm[ i * channelCount + c ] / 32768.0;
+		}
+		mix[ i ] /= channelCount;
+	}
+	KissDouble kissDouble( dataSize );
+	kissDouble.setData( &pcm[ 0 ], channelCount, KissDouble::Channel::DOWNMIX );
+	err = Reference( mix ).error( kissDouble );
+	expect( err <= 1e-12, "int16_t downmix", dataSize, err );
+}
+
+// Largest difference of data from samples
+static double dataError( const float *data, const vector<float> &samples )
+{
+	double err = 0.0;
+	for ( size_t i = 0; i < samples.size(); ++i ) {
+		err = max( err, fabs( data[ i ] - (double)samples[ i ] ) );
+	}
+	return err;
+}
+
+static void testBorrow()
+{
+	const int32_t dataSize		= 1024;
+	vector<double> signal		= makeSignal( dataSize );
+	vector<double> other		= makeSignal( dataSize );
+	vector<float> expected		= toSamples<float>( signal );
+	vector<float> otherSamples	= toSamples<float>( other );
+	Reference reference( signal );
+	Kiss kiss( dataSize );
+
+	// The spectrum is of the borrowed buffer, and getData() copies
+	// it, after which the buffer is no longer read
+	{
+		vector<float> samples = toSamples<float>( signal );
+		kiss.borrowData( &samples[ 0 ] );
+		double err = reference.error( kiss );
+		expect( err <= 1e-5, "borrow", dataSize, err );
+		const float *data = kiss.getData();
+		expect( data != &samples[ 0 ], "borrow copy", dataSize, 0.0 );
+		err = dataError( data, expected );
+		expect( err == 0.0, "borrow copy", dataSize, err );
+		copy( otherSamples.begin(), otherSamples.end(), samples.begin() );
+		err = reference.error( kiss );
+		expect( err <= 1e-5, "borrow copied", dataSize, err );
+		err = dataError( kiss.getData(), expected );
+		expect( err == 0.0, "borrow copied", dataSize, err );
+	}
+
+	// getData() before the spectrum copies too, and the spectrum is
+	// then of the copy
+	{
+		vector<float> samples = toSamples<float>( signal );
+		kiss.borrowData( &samples[ 0 ] );
+		double err = dataError( kiss.getData(), expected );
+		expect( err == 0.0, "borrow data first", dataSize, err );
+		copy( otherSamples.begin(), otherSamples.end(), samples.begin() );
+		err = reference.error( kiss );
+		expect( err <= 1e-5, "borrow data first", dataSize, err );
+	}
+
+	// The buffer may go once setData(), borrowData() or setDataSize()
+	// has been called
+	for ( int32_t call = 0; call < 3; ++call ) {
+		{
+			vector<float> samples = toSamples<float>( signal );
+			kiss.borrowData( &samples[ 0 ] );
+			if ( call == 0 ) {
+				kiss.setData( &otherSamples[ 0 ] );
+			} else if ( call == 1 ) {
+				kiss.borrowData( &otherSamples[ 0 ] );
+			} else {
+				kiss.setDataSize( dataSize );
+				kiss.setData( &otherSamples[ 0 ] );
+			}
+		}
+		double err = Reference( other ).error( kiss );
+		expect( err <= 1e-5, "borrow replaced", dataSize, err );
+		err = dataError( kiss.getData(), otherSamples );
+		expect( err == 0.0, "borrow replaced", dataSize, err );
+	}
+}
+
+static void testResize()
+{
+	// Every size change lays the instance out again
+	Kiss kiss( 256 );
+	const int32_t sizes[] = { 1024, 2018, 64, 4096, 30, 512 };
+	for ( size_t s = 0; s < sizeof( sizes ) / sizeof( sizes[ 0 ] ); ++s ) {
+		kiss.setDataSize( sizes[ s ] );
+		expect( kiss.getDataSize() == sizes[ s ] && kiss.getBinSize() == sizes[ s ] / 2 + 1, "resize", sizes[ s ], 0.0 );
+		checkSpectrum( kiss, "resize", 1e-5, 1e-4 );
+	}
+
+	// After reserve(), power of two sizes up to the capacity do
+	// not allocate
+	CountingResource memory;
+	{
+		Kiss reserved( 512, 0, &memory );
+		reserved.reserve( 8192 );
+		int32_t count = memory.mCount;
+		for ( int32_t dataSize = 8192; dataSize >= 16; dataSize /= 2 ) {
+			reserved.setDataSize( dataSize );
+			checkSpectrum( reserved, "reserve", 1e-5, 1e-4 );
+		}
+		reserved.setDataSize( 8192 );
+		expect( memory.mCount == count, "reserve allocations", 8192, memory.mCount - count );
+	}
+
+	// A capacity from the constructor does the same
+	{
+		Kiss reserved( 64, 4096, &memory );
+		int32_t count = memory.mCount;
+		reserved.setDataSize( 4096 );
+		reserved.setDataSize( 128 );
+		checkSpectrum( reserved, "capacity", 1e-5, 1e-4 );
+		expect( memory.mCount == count, "capacity allocations", 4096, memory.mCount - count );
+	}
+}
+
+static void testMove()
+{
+	static_assert( is_nothrow_move_constructible<Kiss>::value, "Kiss must move without throwing" );
+	static_assert( is_nothrow_move_assignable<Kiss>::value, "Kiss must move without throwing" );
+	static_assert( !is_copy_constructible<Kiss>::value, "Kiss must not copy" );
+
+	// The spectrum moves with the instance
+	vector<double> signal	= makeSignal( 1024 );
+	vector<float> samples	= toSamples<float>( signal );
+	Reference reference( signal );
+	Kiss source( 1024 );
+	source.setData( &samples[ 0 ] );
+	Kiss moved( std::move( source ) );
+	double err = reference.error( moved );
+	expect( err <= 1e-5, "move construct", 1024, err );
+
+	Kiss assigned( 16 );
+	assigned = std::move( moved );
+	err = reference.error( assigned );
+	expect( err <= 1e-5, "move assign", 1024, err );
+
+	// A moved-from instance may be given a size again
+	source.setDataSize( 512 );
+	checkSpectrum( source, "moved-from", 1e-5, 1e-4 );
+
+	// Containers grow by moving their instances
+	vector<Kiss> instances;
+	for ( int32_t i = 0; i < 16; ++i ) {
+		instances.emplace_back( 64 + 2 * i );
+	}
+	for ( size_t i = 0; i < instances.size(); ++i ) {
+		checkSpectrum( instances[ i ], "vector", 1e-5, 1e-4 );
+	}
+}
+
+static void testFilter()
+{
+	const int32_t dataSize	= 1024;
+	vector<double> signal	= makeSignal( dataSize );
+	vector<float> samples	= toSamples<float>( signal );
+	Kiss kiss( dataSize );
+
+	kiss.setFilter( 0.25f, Kiss::Filter::LOW_PASS );
+	kiss.setData( &samples[ 0 ] );
+	double err = Reference( signal, 0.0f, 0.25f ).error( kiss );
+	expect( err <= 1e-5, "low pass", dataSize, err );
+
+	kiss.setFilter( 0.1f, 0.5f );
+	kiss.setData( &samples[ 0 ] );
+	err = Reference( signal, 0.1f, 0.5f ).error( kiss );
+	expect( err <= 1e-5, "band pass", dataSize, err );
+
+	kiss.removeFilter();
+	kiss.setData( &samples[ 0 ] );
+	err = Reference( signal ).error( kiss );
+	expect( err <= 1e-5, "no filter", dataSize, err );
+}
+
+static void testStereo()
+{
+	// Two different signals, so that a swap or a leak of one channel
+	// into the other shows
+	const int32_t sizes[] = { 16, 30, 512, 1000, 2048 };
+	for ( size_t s = 0; s < sizeof( sizes ) / sizeof( sizes[ 0 ] ); ++s ) {
+		const int32_t dataSize	= sizes[ s ];
+		vector<double> signal	= makeSignal( dataSize );
+		vector<float> left		= toSamples<float>( signal );
+		vector<float> right( dataSize );
+		vector<float> frames( dataSize * 2 );
+		for ( int32_t i = 0; i < dataSize; ++i ) {
+			right[ i ]			= 0.75f * left[ dataSize - 1 - i ] + 0.2f * (float)sin( i * 2.1 );
+			frames[ i * 2 ]		= left[ i ];
+			frames[ i * 2 + 1 ]	= right[ i ];
+		}
+		Kiss kissLeft( dataSize );
+		Kiss kissRight( dataSize );
+		kissLeft.setData( &left[ 0 ] );
+		kissRight.setData( &right[ 0 ] );
+
+		KissStereoRef stereo = KissStereo::create( dataSize );
+		for ( int32_t pass = 0; pass < 2; ++pass ) {
+			if ( pass == 0 ) {
+				stereo->setData( &left[ 0 ], &right[ 0 ] );
+			} else {
+				stereo->setData( &frames[ 0 ] );
+			}
+			const char *what = pass == 0 ? "stereo" : "stereo interleaved";
+			const int32_t l = KissStereo::Channel::LEFT;
+			const int32_t r = KissStereo::Channel::RIGHT;
+			double err = channelError( kissLeft, stereo->getReal( l ), stereo->getImaginary( l ), stereo->getAmplitude( l ), stereo->getPhase( l ) );
+			expect( err <= 1e-5, what, dataSize, err );
+			err = channelError( kissRight, stereo->getReal( r ), stereo->getImaginary( r ), stereo->getAmplitude( r ), stereo->getPhase( r ) );
+			expect( err <= 1e-5, what, dataSize, err );
+		}
+	}
+}
+
+static void testBatch()
+{
+	const int32_t channelCount	= 3;
+	const int32_t sizes[]		= { 16, 30, 512, 1000, 2048 };
+	for ( size_t s = 0; s < sizeof( sizes ) / sizeof( sizes[ 0 ] ); ++s ) {
+		const int32_t dataSize	= sizes[ s ];
+		KissBatchRef batch		= KissBatch::create( channelCount, dataSize );
+		vector<vector<float> > samples( channelCount );
+		for ( int32_t c = 0; c < channelCount; ++c ) {
+			vector<double> signal = makeSignal( dataSize );
+			samples[ c ] = toSamples<float>( signal );
+			batch->setData( c, &samples[ c ][ 0 ] );
+		}
+
+		// Each channel against its own instance
+		for ( int32_t c = 0; c < channelCount; ++c ) {
+			Kiss kiss( dataSize );
+			kiss.setData( &samples[ c ][ 0 ] );
+			double err = channelError( kiss, batch->getReal( c ), batch->getImaginary( c ), batch->getAmplitude( c ), batch->getPhase( c ) );
+			expect( err <= 1e-5, "batch", dataSize, err );
+		}
+
+		// Setting one channel again leaves the others as they were
+		vector<double> signal = makeSignal( dataSize );
+		samples[ 1 ] = toSamples<float>( signal );
+		batch->setData( 1, &samples[ 1 ][ 0 ] );
+		for ( int32_t c = 0; c < channelCount; ++c ) {
+			Kiss kiss( dataSize );
+			kiss.setData( &samples[ c ][ 0 ] );
+			double err = channelError( kiss, batch->getReal( c ), batch->getImaginary( c ), batch->getAmplitude( c ), batch->getPhase( c ) );
+			expect( err <= 1e-5, "batch update", dataSize, err );
+		}
+	}
+}
+
+#if __cplusplus >= 201402L || ( defined( _MSVC_LANG ) && _MSVC_LANG >= 201402L )
+template<int N>
+static void checkFixed()
+{
+	vector<double> signal	= makeSignal( N );
+	vector<float> samples	= toSamples<float>( signal );
+	KissFixed<N> kiss;
+	kiss.setData( &samples[ 0 ] );
+	double err = Reference( signal ).error( kiss );
+	expect( err <= 1e-5, "KissFixed", N, err );
+}
+
+static void testFixed()
+{
+	checkFixed<4>();
+	checkFixed<8>();
+	checkFixed<64>();
+	checkFixed<512>();
+	checkFixed<2048>();
+}
+#else
+static void testFixed() {}
+#endif
+
+int main()
+{
+	srand( 1 );
+	testPrecisions();
+	testPcm();
+	testDownmix();
+	testBorrow();
+	testResize();
+	testMove();
+	testFilter();
+	testStereo();
+	testBatch();
+	testFixed();
+	printf( "%d checks, %d failures\n", sChecks, sFailures );
+	return sFailures;
+}
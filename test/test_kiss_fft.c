@@ -0,0 +1,575 @@
+/*
+ Checks of the kiss core.
+
+ Every executor and SIMD level is compared against a naive DFT, over
+ sizes that take each radix, the generic butterfly, Bluestein's
+ algorithm, the parallel and the six-step executors. The real, batch
+ and double/int16 transforms are compared the same way, the
+ out-of-core ones against the in-memory transforms, and the
+ reentrant paths (kiss_fft_scratch, kiss_fftr_scratch) are run from
+ two threads sharing one cfg.
+
+ There is no build system; compile it with the sources of src/kiss,
+ from the root of the repository:
+
+     gcc -O2 -Isrc/kiss test/test_kiss_fft.c src/kiss/[a-z]*.c -lpthread -lm -o test_kiss_fft
+
+ or, with Visual Studio, add it to a console project together with
+ the files of vc10/KissFFTLib.vcxproj. Each failed check prints a line;
+ the exit code is the number of failures.
+ */
+
+#include "kiss_fft.h"
+#include "kiss_fftr.h"
+#include "kiss_fft_batch.h"
+#include "kiss_fft_ooc.h"
+#include "kiss_fft_sets.h"
+
+#if defined(_MSC_VER)
+#  include <windows.h>
+#  include <process.h>
+typedef HANDLE test_thread;
+#  define TEST_THREAD_FN unsigned __stdcall
+#  define TEST_THREAD_RETURN 0
+#else
+#  include <pthread.h>
+typedef pthread_t test_thread;
+#  define TEST_THREAD_FN void *
+#  define TEST_THREAD_RETURN NULL
+#endif
+
+/* files written by the checks, removed when done */
+#define TEST_WISDOM_PATH "test_kiss_fft.wisdom"
+#define TEST_OOC_IN_PATH "test_kiss_fft.in"
+#define TEST_OOC_OUT_PATH "test_kiss_fft.out"
+
+/* larger sizes are checked on this many bins instead of all of them */
+#define TEST_FULL_DFT 4096
+#define TEST_BINS 24
+
+static const double test_pi = 3.141592653589793238462643383279502884197169399375105820974944;
+
+static int test_checks = 0;
+static int test_failures = 0;
+
+static void test_expect(int ok,const char * what,int nfft,int executor,int level,double err)
+{
+    ++test_checks;
+    if (!ok) {
+        ++test_failures;
+        printf("FAIL %s nfft=%d executor=%d simd=%d err=%g\n",what,nfft,executor,level,err);
+    }
+}
+
+static double test_random(void)
+{
+    return rand() / (double)RAND_MAX - .5;
+}
+
+static void test_fill(kiss_fft_cpx * x,int n)
+{
+    int i;
+    for (i=0;i<n;++i) {
+        x[i].r = (kiss_fft_scalar)test_random();
+        x[i].i = (kiss_fft_scalar)test_random();
+    }
+}
+
+/* the root sum of squares of x, the rms of its spectrum (Parseval) */
+static double test_norm(const kiss_fft_cpx * x,int n)
+{
+    double s = 0;
+    int i;
+    for (i=0;i<n;++i)
+        s += (double)x[i].r*x[i].r + (double)x[i].i*x[i].i;
+    return sqrt(s);
+}
+
+/* bin k of the DFT of x, in double */
+static void test_dft_bin(const kiss_fft_cpx * x,int n,int k,int inverse,double * re,double * im)
+{
+    const double sign = inverse ? 2*test_pi : -2*test_pi;
+    double sr = 0, si = 0;
+    long long a = 0; /* i*k mod n */
+    int i;
+    for (i=0;i<n;++i) {
+        const double phase = sign * (double)a / n;
+        const double c = cos(phase), s = sin(phase);
+        sr += x[i].r*c - x[i].i*s;
+        si += x[i].r*s + x[i].i*c;
+        a += k;
+        if (a >= n)
+            a -= n;
+    }
+    *re = sr;
+    *im = si;
+}
+
+/* bins of the DFT of in that plans are checked on: all of them for
+   small sizes, TEST_BINS otherwise */
+typedef struct {
+    int nbins;
+    int * k;
+    double * re;
+    double * im;
+} test_reference;
+
+static void test_reference_init(test_reference * r,const kiss_fft_cpx * in,int n,int inverse)
+{
+    int b;
+    r->nbins = n <= TEST_FULL_DFT ? n : TEST_BINS;
+    r->k = (int*)malloc(sizeof(int)*r->nbins);
+    r->re = (double*)malloc(sizeof(double)*r->nbins);
+    r->im = (double*)malloc(sizeof(double)*r->nbins);
+    for (b=0;b<r->nbins;++b) {
+        /* the first and a random spread of the others */
+        r->k[b] = n <= TEST_FULL_DFT || b < TEST_BINS/2 ? b : rand() % n;
+        test_dft_bin(in,n,r->k[b],inverse,r->re+b,r->im+b);
+    }
+}
+
+static void test_reference_free(test_reference * r)
+{
+    free(r->k);
+    free(r->re);
+    free(r->im);
+}
+
+/* largest error of out on the bins of r */
+static double test_reference_error(const test_reference * r,const kiss_fft_cpx * out)
+{
+    double err = 0;
+    int b;
+    for (b=0;b<r->nbins;++b) {
+        const kiss_fft_cpx * y = out + r->k[b];
+        double e = sqrt( (r->re[b]-y->r)*(r->re[b]-y->r) + (r->im[b]-y->i)*(r->im[b]-y->i) );
+        if (e > err)
+            err = e;
+    }
+    return err;
+}
+
+static double test_max_diff(const kiss_fft_cpx * a,const kiss_fft_cpx * b,int n)
+{
+    double err = 0;
+    int i;
+    for (i=0;i<n;++i) {
+        double e = fabs(a[i].r - b[i].r) + fabs(a[i].i - b[i].i);
+        if (e > err)
+            err = e;
+    }
+    return err;
+}
+
+/* every executor at every SIMD level, out of place and in place; the
+   first plan is the reference for the rest on bins the DFT skips */
+static void test_complex(int nfft,int inverse)
+{
+    kiss_fft_cfg cfg = kiss_fft_alloc(nfft,inverse,NULL,NULL);
+    kiss_fft_cpx * in = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*nfft);
+    kiss_fft_cpx * out = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*nfft);
+    kiss_fft_cpx * ref = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*nfft);
+    test_reference dft;
+    double norm,err;
+    int executor,level;
+
+    test_fill(in,nfft);
+    norm = test_norm(in,nfft);
+    test_reference_init(&dft,in,nfft,inverse);
+    for (executor=KISS_FFT_EXEC_RECURSIVE;executor<=KISS_FFT_EXEC_SIXSTEP;++executor) {
+        for (level=KISS_FFT_SIMD_NONE;level<=kiss_fft_simd_level();++level) {
+            kiss_fft_set_executor(cfg,executor);
+            kiss_fft_set_simd_level(cfg,level);
+            kiss_fft(cfg,in,out);
+            err = test_reference_error(&dft,out);
+            test_expect(err <= 1e-5*norm,inverse ? "inverse dft" : "forward dft",nfft,executor,level,err/norm);
+
+            if (executor == KISS_FFT_EXEC_RECURSIVE && level == KISS_FFT_SIMD_NONE)
+                memcpy(ref,out,sizeof(kiss_fft_cpx)*nfft);
+            err = test_max_diff(ref,out,nfft);
+            test_expect(err <= 1e-5*norm,"agreement",nfft,executor,level,err/norm);
+
+            memcpy(out,in,sizeof(kiss_fft_cpx)*nfft);
+            kiss_fft(cfg,out,out);
+            err = test_max_diff(ref,out,nfft);
+            test_expect(err <= 1e-5*norm,"in place",nfft,executor,level,err/norm);
+        }
+    }
+    test_reference_free(&dft);
+    free(in);
+    free(out);
+    free(ref);
+    kiss_fft_free(cfg);
+}
+
+/* kiss_fftr against the DFT, and kiss_fftri back */
+static void test_real(int nfft)
+{
+    kiss_fftr_cfg fwd = kiss_fftr_alloc(nfft,0,NULL,NULL);
+    kiss_fftr_cfg inv = kiss_fftr_alloc(nfft,1,NULL,NULL);
+    kiss_fft_scalar * x = (kiss_fft_scalar*)malloc(sizeof(kiss_fft_scalar)*nfft);
+    kiss_fft_scalar * y = (kiss_fft_scalar*)malloc(sizeof(kiss_fft_scalar)*nfft);
+    kiss_fft_cpx * cx = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*nfft);
+    kiss_fft_cpx * X = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*(nfft/2+1));
+    double norm,err = 0;
+    int i,k;
+
+    for (i=0;i<nfft;++i) {
+        x[i] = (kiss_fft_scalar)test_random();
+        cx[i].r = x[i];
+        cx[i].i = 0;
+    }
+    norm = test_norm(cx,nfft);
+    kiss_fftr(fwd,x,X);
+    for (k=0;k<=nfft/2;++k) {
+        double re,im,e;
+        if (nfft > TEST_FULL_DFT && k >= TEST_BINS)
+            break;
+        test_dft_bin(cx,nfft,k,0,&re,&im);
+        e = sqrt( (re-X[k].r)*(re-X[k].r) + (im-X[k].i)*(im-X[k].i) );
+        if (e > err)
+            err = e;
+    }
+    test_expect(err <= 1e-5*norm,"real dft",nfft,0,kiss_fft_simd_level(),err/norm);
+
+    kiss_fftri(inv,X,y);
+    err = 0;
+    for (i=0;i<nfft;++i)
+        if (fabs(y[i]/nfft - x[i]) > err)
+            err = fabs(y[i]/nfft - x[i]);
+    test_expect(err <= 1e-5,"real round trip",nfft,0,kiss_fft_simd_level(),err);
+
+    free(x);
+    free(y);
+    free(cx);
+    free(X);
+    kiss_fftr_free(fwd);
+    kiss_fftr_free(inv);
+}
+
+/* kiss_fftr_batch and kiss_fftri_batch against kiss_fftr per channel */
+static void test_batch(int nfft,int lanes,int nchannels)
+{
+    kiss_fftr_batch_cfg batch = kiss_fftr_batch_alloc(nfft,0,lanes,NULL,NULL);
+    kiss_fftr_cfg real = kiss_fftr_alloc(nfft,0,NULL,NULL);
+    kiss_fft_scalar ** x = (kiss_fft_scalar**)malloc(sizeof(kiss_fft_scalar*)*nchannels);
+    kiss_fft_scalar ** y = (kiss_fft_scalar**)malloc(sizeof(kiss_fft_scalar*)*nchannels);
+    kiss_fft_cpx ** X = (kiss_fft_cpx**)malloc(sizeof(kiss_fft_cpx*)*nchannels);
+    kiss_fft_cpx * ref = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*(nfft/2+1));
+    double err = 0,rt = 0;
+    int c,i;
+
+    for (c=0;c<nchannels;++c) {
+        x[c] = (kiss_fft_scalar*)malloc(sizeof(kiss_fft_scalar)*nfft);
+        y[c] = (kiss_fft_scalar*)malloc(sizeof(kiss_fft_scalar)*nfft);
+        X[c] = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*(nfft/2+1));
+        for (i=0;i<nfft;++i)
+            x[c][i] = (kiss_fft_scalar)test_random();
+    }
+    kiss_fftr_batch(batch,(const kiss_fft_scalar * const *)x,X,nchannels);
+    kiss_fftri_batch(batch,(const kiss_fft_cpx * const *)X,y,nchannels);
+    for (c=0;c<nchannels;++c) {
+        kiss_fftr(real,x[c],ref);
+        if (test_max_diff(ref,X[c],nfft/2+1) > err)
+            err = test_max_diff(ref,X[c],nfft/2+1);
+        for (i=0;i<nfft;++i)
+            if (fabs(y[c][i]/nfft - x[c][i]) > rt)
+                rt = fabs(y[c][i]/nfft - x[c][i]);
+    }
+    test_expect(err <= 1e-5*nfft,"batch",nfft,lanes,kiss_fftr_batch_lanes(batch),err);
+    test_expect(rt <= 1e-5,"batch round trip",nfft,lanes,kiss_fftr_batch_lanes(batch),rt);
+
+    for (c=0;c<nchannels;++c) {
+        free(x[c]);
+        free(y[c]);
+        free(X[c]);
+    }
+    free(x);
+    free(y);
+    free(X);
+    free(ref);
+    kiss_fftr_batch_free(batch);
+    kiss_fftr_free(real);
+}
+
+/* the double and, unless fixed is 0, the int16_t symbol set; a large
+   prime factor, with no Bluestein in fixed point, costs int16_t more
+   rounding than the check allows */
+static void test_sets(int nfft,int fixed)
+{
+    kiss_fft_cfg_f64 c64 = kiss_fft_alloc_f64(nfft,0,NULL,NULL);
+    kiss_fft_cfg_s16 c16 = kiss_fft_alloc_s16(nfft,0,NULL,NULL);
+    kiss_fft_cpx_f64 * in64 = (kiss_fft_cpx_f64*)malloc(sizeof(kiss_fft_cpx_f64)*nfft);
+    kiss_fft_cpx_f64 * out64 = (kiss_fft_cpx_f64*)malloc(sizeof(kiss_fft_cpx_f64)*nfft);
+    kiss_fft_cpx_s16 * in16 = (kiss_fft_cpx_s16*)malloc(sizeof(kiss_fft_cpx_s16)*nfft);
+    kiss_fft_cpx_s16 * out16 = (kiss_fft_cpx_s16*)malloc(sizeof(kiss_fft_cpx_s16)*nfft);
+    kiss_fft_cpx * in = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*nfft);
+    double err64 = 0,err16 = 0,norm;
+    int i;
+
+    for (i=0;i<nfft;++i) {
+        in16[i].r = (int16_t)(test_random() * 32767);
+        in16[i].i = (int16_t)(test_random() * 32767);
+        in64[i].r = in[i].r = in16[i].r / 32768.f;
+        in64[i].i = in[i].i = in16[i].i / 32768.f;
+    }
+    norm = test_norm(in,nfft);
+    kiss_fft_f64(c64,in64,out64);
+    kiss_fft_s16(c16,in16,out16);
+    for (i=0;i<nfft;++i) {
+        double re,im,e;
+        test_dft_bin(in,nfft,i,0,&re,&im);
+        e = fabs(re - out64[i].r) + fabs(im - out64[i].i);
+        if (e > err64)
+            err64 = e;
+        /* the fixed point transform scales by 1/nfft */
+        e = fabs(re - out16[i].r * (double)nfft / 32768) + fabs(im - out16[i].i * (double)nfft / 32768);
+        if (e > err16)
+            err16 = e;
+    }
+    test_expect(err64 <= 1e-12*norm,"double set",nfft,0,0,err64/norm);
+    /* each stage rounds to Q15 after scaling down, which a wrong
+       transform would still exceed by far */
+    if (fixed)
+        test_expect(err16 <= 5e-2*norm,"int16_t set",nfft,0,0,err16/norm);
+
+    free(in64);
+    free(out64);
+    free(in16);
+    free(out16);
+    free(in);
+    kiss_fft_free(c64);
+    kiss_fft_free(c16);
+}
+
+/* writes n bytes of data to path; 0 on success */
+static int test_write_file(const char * path,const void * data,size_t n)
+{
+    FILE * f = fopen(path,"wb");
+    int ret = -1;
+    if (f) {
+        ret = fwrite(data,1,n,f) == n ? 0 : -1;
+        fclose(f);
+    }
+    return ret;
+}
+
+static int test_read_file(const char * path,void * data,size_t n)
+{
+    FILE * f = fopen(path,"rb");
+    int ret = -1;
+    if (f) {
+        ret = fread(data,1,n,f) == n ? 0 : -1;
+        fclose(f);
+    }
+    return ret;
+}
+
+/* kiss_fft_ooc, or kiss_fftr_ooc if real, against the transform in
+   memory. memlimit holds a quarter of the points, so both passes take
+   several blocks of columns */
+static void test_ooc(int nfft,int real)
+{
+    const int nout = real ? nfft/2+1 : nfft;
+    const size_t memlimit = sizeof(kiss_fft_cpx) * (real ? nfft/2 : nfft) / 4;
+    kiss_fft_cpx * in = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*nfft);
+    kiss_fft_cpx * out = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*nout);
+    kiss_fft_cpx * ref = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*nout);
+    double norm,err = -1;
+    int ret;
+
+    test_fill(in,nfft);
+    if (real) {
+        kiss_fftr_cfg cfg = kiss_fftr_alloc(nfft,0,NULL,NULL);
+        kiss_fftr(cfg,(const kiss_fft_scalar*)in,ref);
+        kiss_fftr_free(cfg);
+        ret = test_write_file(TEST_OOC_IN_PATH,in,sizeof(kiss_fft_scalar)*nfft);
+        if (ret == 0)
+            ret = kiss_fftr_ooc(TEST_OOC_IN_PATH,TEST_OOC_OUT_PATH,NULL,nfft,memlimit);
+    }else{
+        kiss_fft_cfg cfg = kiss_fft_alloc(nfft,0,NULL,NULL);
+        kiss_fft(cfg,in,ref);
+        kiss_fft_free(cfg);
+        ret = test_write_file(TEST_OOC_IN_PATH,in,sizeof(kiss_fft_cpx)*nfft);
+        if (ret == 0)
+            ret = kiss_fft_ooc(TEST_OOC_IN_PATH,TEST_OOC_OUT_PATH,NULL,nfft,0,memlimit);
+    }
+    if (ret == 0)
+        ret = test_read_file(TEST_OOC_OUT_PATH,out,sizeof(kiss_fft_cpx)*nout);
+    norm = test_norm(in,real ? nfft/2 : nfft);
+    if (ret == 0)
+        err = test_max_diff(ref,out,nout) / norm;
+    test_expect(ret == 0 && err <= 1e-5,real ? "real out of core" : "out of core",nfft,0,0,err);
+    remove(TEST_OOC_IN_PATH);
+    remove(TEST_OOC_OUT_PATH);
+
+    free(in);
+    free(out);
+    free(ref);
+}
+
+/* two threads transforming with one cfg, each in its own scratch */
+typedef struct {
+    kiss_fft_cfg cfg;
+    kiss_fftr_cfg rcfg;
+    int nfft;
+    int iterations;
+    const kiss_fft_cpx * in;
+    const kiss_fft_cpx * ref;
+    int bad;
+} test_shared;
+
+static TEST_THREAD_FN test_worker(void * arg)
+{
+    test_shared * t = (test_shared*)arg;
+    const int nout = t->cfg ? t->nfft : t->nfft/2+1;
+    void * scratch = malloc(t->cfg ? kiss_fft_scratch_size(t->cfg) : kiss_fftr_scratch_size(t->rcfg));
+    kiss_fft_cpx * out = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*nout);
+    int it;
+
+    t->bad = 0;
+    for (it=0;it<t->iterations;++it) {
+        if (t->cfg)
+            kiss_fft_scratch(t->cfg,t->in,out,scratch);
+        else
+            kiss_fftr_scratch(t->rcfg,(const kiss_fft_scalar*)t->in,out,scratch);
+        if (memcmp(out,t->ref,sizeof(kiss_fft_cpx)*nout) != 0)
+            ++t->bad;
+    }
+    free(scratch);
+    free(out);
+    return TEST_THREAD_RETURN;
+}
+
+static void test_thread_start(test_thread * thread,test_shared * t)
+{
+#if defined(_MSC_VER)
+    *thread = (HANDLE)_beginthreadex(NULL,0,test_worker,t,0,NULL);
+#else
+    pthread_create(thread,NULL,test_worker,t);
+#endif
+}
+
+static void test_thread_join(test_thread thread)
+{
+#if defined(_MSC_VER)
+    WaitForSingleObject(thread,INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread,NULL);
+#endif
+}
+
+/* executor -1 keeps the one kiss_fft_alloc chose; real tests kiss_fftr */
+static void test_reentrant(int nfft,int executor,int real,int iterations)
+{
+    test_shared t[2];
+    test_thread threads[2];
+    kiss_fft_cpx * in = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*nfft);
+    kiss_fft_cpx * ref = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*nfft);
+    void * scratch;
+    int i;
+
+    test_fill(in,nfft);
+    t[0].cfg = real ? NULL : kiss_fft_alloc(nfft,0,NULL,NULL);
+    t[0].rcfg = real ? kiss_fftr_alloc(nfft,0,NULL,NULL) : NULL;
+    if (t[0].cfg && executor >= 0)
+        kiss_fft_set_executor(t[0].cfg,executor);
+    scratch = malloc(real ? kiss_fftr_scratch_size(t[0].rcfg) : kiss_fft_scratch_size(t[0].cfg));
+    if (real)
+        kiss_fftr_scratch(t[0].rcfg,(const kiss_fft_scalar*)in,ref,scratch);
+    else
+        kiss_fft_scratch(t[0].cfg,in,ref,scratch);
+    free(scratch);
+
+    t[0].nfft = nfft;
+    t[0].iterations = iterations;
+    t[0].in = in;
+    t[0].ref = ref;
+    t[1] = t[0];
+    for (i=0;i<2;++i)
+        test_thread_start(threads+i,t+i);
+    for (i=0;i<2;++i)
+        test_thread_join(threads[i]);
+    test_expect(t[0].bad + t[1].bad == 0,real ? "real reentrancy" : "reentrancy",nfft,executor,kiss_fft_simd_level(),
+                t[0].bad + t[1].bad);
+
+    free(in);
+    free(ref);
+    kiss_fft_free(t[0].cfg);
+    kiss_fftr_free(t[0].rcfg);
+}
+
+int main(void)
+{
+    static const int sizes[] = {
+        1, 2, 3, 4, 5, 6, 7, 8, 11, 12, 16, 29, 31, 32, 60, 64, 100, 127, 128,
+        243, 256, 257, 500, 512, 768, 1000, 1009, 1024, 2017, 2042, 2048,
+        3125, 4096, 4100,
+        /* parallel, Bluestein inside the parallel executor, six-step, and
+           a prime whose Bluestein plan is itself of six-step size */
+        65536, 4*40009, 1<<20, 524309
+    };
+    static const int lanes[] = { 0, 4, 8, 16 };
+    FILE * f;
+    unsigned s;
+    int n;
+
+    srand(1);
+
+    /* four threads whatever the processor count, so that the parallel
+       executor splits its plans rather than falling back to recursion */
+    kiss_fft_set_threads(4);
+    for (s=0;s<sizeof(sizes)/sizeof(sizes[0]);++s) {
+        test_complex(sizes[s],0);
+        test_complex(sizes[s],1);
+        if (sizes[s] % 2 == 0)
+            test_real(sizes[s]);
+    }
+    for (s=0;s<sizeof(lanes)/sizeof(lanes[0]);++s) {
+        test_batch(512,lanes[s],37);
+        test_batch(1000,lanes[s],5);
+    }
+    test_sets(256,1);
+    test_sets(1000,1);
+    test_sets(1009,0);
+
+    /* 4036 and 8072 split into rows of 1009 points, a Bluestein size */
+    test_ooc(1024,0);
+    test_ooc(12288,0);
+    test_ooc(4036,0);
+    test_ooc(65536,0);
+    test_ooc(2048,1);
+    test_ooc(8072,1);
+    test_expect(kiss_fft_ooc(TEST_OOC_IN_PATH,TEST_OOC_OUT_PATH,NULL,0,0,1<<20) == -1,"out of core nfft 0",0,0,0,0);
+    test_expect(kiss_fft_ooc(TEST_OOC_IN_PATH,TEST_OOC_OUT_PATH,NULL,-8,0,1<<20) == -1,"out of core nfft -8",-8,0,0,0);
+    test_expect(kiss_fftr_ooc(TEST_OOC_IN_PATH,TEST_OOC_OUT_PATH,NULL,0,1<<20) == -1,"real out of core nfft 0",0,0,0,0);
+
+    test_reentrant(1009,-1,0,4000);
+    test_reentrant(1009,KISS_FFT_EXEC_STOCKHAM,0,4000);
+    test_reentrant(4096,KISS_FFT_EXEC_STOCKHAM,0,4000);
+    test_reentrant(2018,-1,1,4000);
+    test_reentrant(4*40009,KISS_FFT_EXEC_PARALLEL,0,8);
+    kiss_fft_set_threads(0);
+    test_reentrant(524309,-1,0,4);
+
+    /* wisdom that picks the Stockham executor for the power of two
+       sizes must not reach the Bluestein plans inside a cfg */
+    f = fopen(TEST_WISDOM_PATH,"w");
+    if (f) {
+        fprintf(f,"kissfft-wisdom 1\n");
+        for (n=1024;n<=8192;n*=2)
+            fprintf(f,"%d 0 %d 0 %d 0\n",n,(int)sizeof(kiss_fft_scalar)*2,KISS_FFT_EXEC_STOCKHAM);
+        fclose(f);
+    }
+    test_expect(kiss_fft_import_wisdom(TEST_WISDOM_PATH) == 0,"import wisdom",0,KISS_FFT_EXEC_STOCKHAM,0,0);
+    remove(TEST_WISDOM_PATH);
+    test_reentrant(1009,-1,0,4000);
+    test_reentrant(2018,-1,1,4000);
+    test_complex(1009,0);
+    kiss_fft_forget_wisdom();
+
+    kiss_fft_cleanup();
+    printf("%d checks, %d failures\n",test_checks,test_failures);
+    return test_failures;
+}